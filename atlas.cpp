@@ -0,0 +1,214 @@
+/******************************************************************************
+ * atlas.cpp: implements the Atlas
+ *****************************************************************************/
+#include "atlas.h"
+#include <algorithm>
+using namespace std;
+
+/******************************************************************************
+ * TallerFirst: packing order for packShelves
+ *****************************************************************************/
+struct TallerFirst
+{
+   const vector<AtlasRect>* pRects;
+
+   bool operator()(int a, int b) const
+   {
+      const AtlasRect &ra = (*pRects)[a];
+      const AtlasRect &rb = (*pRects)[b];
+      if (ra.height != rb.height)
+         return ra.height > rb.height;
+      return ra.width > rb.width;
+   }
+};
+
+/******************************************************************************
+ * packShelves: packs rectangles into pages in rows ("shelves"), tallest 
+ *    first, each shelf as tall as its first rectangle
+ *****************************************************************************/
+int packShelves(vector<AtlasRect> &rects, int pageSize, int padding)
+{
+   vector<int> order(rects.size());
+   for (int i = 0; i < order.size(); i++)
+      order[i] = i;
+
+   TallerFirst tallerFirst = { &rects };
+   stable_sort(order.begin(), order.end(), tallerFirst);
+
+   int page        = 0;
+   int x           = padding;
+   int y           = padding;
+   int shelfHeight = 0;
+
+   for (int i = 0; i < order.size(); i++)
+   {
+      AtlasRect &rect = rects[order[i]];
+
+      if (rect.width  + 2 * padding > pageSize || 
+          rect.height + 2 * padding > pageSize)
+         throw string("Image too large for an atlas page");
+
+      // Next shelf, then next page
+      if (x + rect.width + padding > pageSize)
+      {
+         x            = padding;
+         y           += shelfHeight + padding;
+         shelfHeight  = 0;
+      }
+      if (y + rect.height + padding > pageSize)
+      {
+         page++;
+         x           = padding;
+         y           = padding;
+         shelfHeight = 0;
+      }
+
+      rect.page = page;
+      rect.x    = x;
+      rect.y    = y;
+
+      x += rect.width + padding;
+      shelfHeight = max(shelfHeight, rect.height);
+   }
+
+   return rects.empty() ? 0 : page + 1;
+}
+
+/******************************************************************************
+ * maskShift: the position of the lowest bit of a color mask
+ *****************************************************************************/
+static int maskShift(Uint32 mask)
+{
+   int shift = 0;
+   while (mask != 0 && (mask & 1) == 0)
+   {
+      mask >>= 1;
+      shift++;
+   }
+   return shift;
+}
+
+/******************************************************************************
+ * copyImage: converts a bitmap to RGBA into its place on a page
+ *    INPUT : surface : the bitmap (3 or 4 bytes per pixel)
+ *            x, y    : where it goes
+ *    OUTPUT: pixels  : the page, ATLAS_PAGE_SIZE pixels wide
+ *****************************************************************************/
+static void copyImage(const SDL_Surface* surface, int x, int y, 
+                      vector<Uint8> &pixels)
+{
+   const SDL_PixelFormat* format = surface->format;
+   int bytes = format->BytesPerPixel;
+
+   // Like Texture, a fourth byte is alpha even when the bitmap says nothing
+   Uint32 masks[4] = { format->Rmask, format->Gmask, format->Bmask, 
+                       format->Amask };
+   if (bytes == 4 && masks[3] == 0)
+      masks[3] = ~(masks[0] | masks[1] | masks[2]);
+
+   int shifts[4];
+   for (int c = 0; c < 4; c++)
+      shifts[c] = maskShift(masks[c]);
+
+   for (int row = 0; row < surface->h; row++)
+   {
+      const Uint8* from = (const Uint8*)surface->pixels + row * surface->pitch;
+      Uint8*       to   = &pixels[((y + row) * ATLAS_PAGE_SIZE + x) * 4];
+
+      for (int col = 0; col < surface->w; col++, from += bytes, to += 4)
+      {
+         Uint32 pixel = from[0] | (from[1] << 8) | (from[2] << 16) |
+                        (bytes == 4 ? (Uint32)from[3] << 24 : 0);
+
+         for (int c = 0; c < 4; c++)
+         {
+            to[c] = masks[c] ? (Uint8)((pixel & masks[c]) >> shifts[c]) 
+                             : 255;
+         }
+      }
+   }
+}
+
+/******************************************************************************
+ * clear: deletes the pages and the images' textures
+ *****************************************************************************/
+void Atlas::clear()
+{
+   for (map<string, Texture*>::iterator it = mImages.begin();
+        it != mImages.end(); it++)
+   {
+      delete it->second;
+   }
+
+   for (int i = 0; i < mPages.size(); i++)
+      delete mPages[i];
+
+   mImages.clear();
+   mPages.clear();
+}
+
+/******************************************************************************
+ * build: reads and packs the images
+ *    INPUT: filenames: the images (24 or 32 bit bitmaps)
+ *           upload   : whether to create the OpenGL textures. Without it 
+ *                      only the layout is worked out (headless mode)
+ *****************************************************************************/
+void Atlas::build(const vector<string> &filenames, bool upload)
+{
+   vector<SDL_Surface*> surfaces;
+   vector<AtlasRect>    rects;
+
+   for (int i = 0; i < filenames.size(); i++)
+   {
+      SDL_Surface* surface = SDL_LoadBMP(filenames[i].c_str());
+      if (surface == NULL)
+      {
+         for (int j = 0; j < surfaces.size(); j++)
+            SDL_FreeSurface(surfaces[j]);
+         throw string("Error reading file " + filenames[i] + ": ") + 
+               SDL_GetError();
+      }
+
+      AtlasRect rect = { surface->w, surface->h, 0, 0, 0 };
+      surfaces.push_back(surface);
+      rects.push_back(rect);
+   }
+
+   int pages = packShelves(rects, ATLAS_PAGE_SIZE, ATLAS_PADDING);
+
+   for (int p = 0; p < pages; p++)
+   {
+      vector<Uint8> pixels;
+
+      if (upload)
+      {
+         pixels.resize(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+         for (int i = 0; i < rects.size(); i++)
+         {
+            if (rects[i].page == p)
+               copyImage(surfaces[i], rects[i].x, rects[i].y, pixels);
+         }
+      }
+
+      mPages.push_back(new Texture(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE,
+                                   upload ? pixels.data() : NULL, upload));
+   }
+
+   for (int i = 0; i < rects.size(); i++)
+   {
+      mImages[filenames[i]] = new Texture(*mPages[rects[i].page], 
+         rects[i].x, rects[i].y, rects[i].width, rects[i].height, 
+         filenames[i]);
+      SDL_FreeSurface(surfaces[i]);
+   }
+}
+
+/******************************************************************************
+ * find: the texture for an image
+ *    OUTPUT: <return>: the texture, or NULL if the image isn't in the atlas
+ *****************************************************************************/
+Texture* Atlas::find(const string &filename) const
+{
+   map<string, Texture*>::const_iterator it = mImages.find(filename);
+   return (it == mImages.end()) ? NULL : it->second;
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+ * atlas.h: defines the Atlas, which packs many small images into a few 
+ *    large textures so that drawing them needs few texture binds
+ *****************************************************************************/
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "texture.h"
+
+/******************************************************************************
+ * Size of an atlas page (square), and the empty border kept around each 
+ *    image so filtering doesn't pick up its neighbours
+ *****************************************************************************/
+#define ATLAS_PAGE_SIZE 1024
+#define ATLAS_PADDING   2
+
+/******************************************************************************
+ * AtlasRect: an image to pack (width, height) and where it went
+ *****************************************************************************/
+struct AtlasRect
+{
+   int width;
+   int height;
+   int page;
+   int x;
+   int y;
+};
+
+/******************************************************************************
+ * packShelves: packs rectangles into pages in rows ("shelves"), tallest 
+ *    first, each shelf as tall as its first rectangle
+ *    INPUT : rects   : the sizes to pack
+ *            pageSize: width and height of a page
+ *            padding : empty space around every rectangle
+ *    OUTPUT: rects   : page, x and y filled in
+ *            <return>: the number of pages used
+ *    Throws a string if a rectangle is larger than a page
+ *****************************************************************************/
+int packShelves(std::vector<AtlasRect> &rects, int pageSize, int padding);
+
+/******************************************************************************
+ * Atlas: images read from disk and packed into pages. Each image is a 
+ *    Texture that shares its page's OpenGL texture. Only images drawn 
+ *    without texture repeat (no TilingSprite) can go in an atlas
+ *****************************************************************************/
+class Atlas
+{
+private:
+
+   std::vector<Texture*>           mPages;
+   std::map<std::string, Texture*> mImages;
+
+public:
+
+   ~Atlas() { clear(); }
+
+   /***************************************************************************
+    * build: reads and packs the images
+    *    INPUT: filenames: the images (24 or 32 bit bitmaps)
+    *           upload   : whether to create the OpenGL textures. Without it 
+    *                      only the layout is worked out (headless mode)
+    *    Throws a string if an image can't be read
+    **************************************************************************/
+   void build(const std::vector<std::string> &filenames, bool upload = true);
+
+   /***************************************************************************
+    * find: the texture for an image
+    *    OUTPUT: <return>: the texture, or NULL if the image isn't in the atlas
+    **************************************************************************/
+   Texture* find(const std::string &filename) const;
+
+   /***************************************************************************
+    * clear: deletes the pages and the images' textures
+    **************************************************************************/
+   void clear();
+
+   int getPages() const { return mPages.size(); }
+};
+
+#endif
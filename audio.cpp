@@ -2,19 +2,42 @@
  * audio.cpp: method definitions for the AudioManager class
  **************************************************************************/
 #include "audio.h"
+#include "mixer.h"
+#include "stream.h"
+#include <algorithm>
 using namespace std;
 
 /******************************************************************************
  * Constructor: initialize SDL and SDL_Sound, get device settings
+ *    INPUT: enabled : when false no audio device is opened and every
+ *                     sound request is silently ignored (headless mode)
+ *           latency : most milliseconds of buffering wanted
+ *           adaptive: whether to grow the buffer when callbacks miss their
+ *                     deadline
  *****************************************************************************/
-AudioManager::AudioManager()
+AudioManager::AudioManager(bool enabled, int latency, bool adaptive)
+   : mCallbackTime(0), mCallbackAvg(0), mCallbackMax(0), mUnderruns(0),
+     mMisses(0)
 {
    // Set defaults
-   mLoaded = false;
-   mVolume = SDL_MIX_MAXVOLUME / 2;
+   mLoaded    = false;
+   mPaused    = true;
+   mAdaptive  = adaptive;
+   mVolume    = SDL_MIX_MAXVOLUME / 2;
+   mMixVolume = mVolume;
+   mDropped   = 0;
+   mPlays     = 0;
 
-   // Audio format specifications
-   SDL_AudioSpec desired;
+   for (int i = 0; i < AUDIO_MAX_VOICES; i++)
+   {
+      mVoices[i].pSound     = NULL;
+      mVoices[i].generation = 0;
+      mFinished[i]          = 0;
+      mPlaying[i]           = 0;
+   }
+
+   if (!enabled)
+      return;
 
    // Initialize SDL audio subsystem
    if (SDL_Init(SDL_INIT_AUDIO) != 0)
@@ -22,43 +45,100 @@ AudioManager::AudioManager()
       throw string("Unable to initialize SDL Audio");
    }
 
+   // The largest power of two that is no longer than the latency asked for
+   int samples = AUDIO_MIN_SAMPLES;
+   while (samples < AUDIO_MAX_SAMPLES && 
+          samples * 2 * 1000 <= latency * AUDIO_FREQUENCY)
+      samples *= 2;
+
+   open(samples);
+
+   // Room for the largest callback, so neither the mixer nor adapt 
+   // allocates
+   mMix.resize(AUDIO_MAX_SAMPLES * mAudioSpec.channels);
+
+   mLoaded = true; // If sound fails to initialize, continue quietly
+
+   pause(false); // Started in paused mode, unpause
+}
+
+/******************************************************************************
+ * open: opens the audio device (paused) and resets the timing. The mixer 
+ *    is not running: the device is either not open yet or closed
+ *    INPUT: samples: buffer size in sample frames
+ *****************************************************************************/
+void AudioManager::open(int samples)
+{
+   // Audio format specifications
+   SDL_AudioSpec desired;
+
    // Open the audio device, attempting to get the desired format
-   desired.freq     = 44100;
+   desired.freq     = AUDIO_FREQUENCY;
    desired.format   = AUDIO_S16;
-   desired.samples  = 4096;
+   desired.samples  = samples;
    desired.channels = 2;
    desired.callback = &audioCallback;
    desired.userdata = this;
 
-   // Is the error somewhere here?
-   if (SDL_OpenAudio(&desired, &mAudioSpec) < 0)
+   // Without an obtained spec SDL converts to the desired format for us, 
+   // which the mixer relies on (it only writes AUDIO_S16)
+   if (SDL_OpenAudio(&desired, NULL) < 0)
    {
       throw string(SDL_GetError()) ;
    }
+   mAudioSpec = desired;
 
-   pause(false); // Started in paused mode, unpause
-
-   mLoaded = true; // If sound fails to initialize, continue quietly
+   mDeadline      = SDL_GetPerformanceFrequency() * samples / desired.freq;
+   mLastCallback  = 0;
+   mCallbackTotal = 0;
+   mCallbacks     = 0;
+   mCallbackMax   = 0;
+   mMisses        = 0;
 }
 
 /******************************************************************************
- * Destructor: delete audio data
+ * adapt: in adaptive mode, reopens the device with twice the buffer once
+ *    AUDIO_ADAPT_MISSES callbacks have missed their deadline at the current
+ *    size. The voices, the queued commands and the loaded sounds all 
+ *    survive, so what is playing carries on after a short gap
  *****************************************************************************/
-AudioManager::~AudioManager()
+void AudioManager::adapt()
 {
-   // Stop all audio from playing (blocks until stopped)
-   stop();
+   if (!mLoaded || !mAdaptive || mMisses < AUDIO_ADAPT_MISSES ||
+       mAudioSpec.samples >= AUDIO_MAX_SAMPLES)
+      return;
 
-   // Pause and lock audio to free resources
-   SDL_PauseAudio(true);    
-   SDL_LockAudio();
+   // Closing waits for the callback to finish, so the mixer's state is 
+   // ours until the device is unpaused again
+   SDL_CloseAudio();
 
-   // Clean-up 
-   for (list<PlaybackInfo*>::iterator iter = mSoundList.begin();
-      iter != mSoundList.end(); iter++)
+   try
+   {
+      open(mAudioSpec.samples * 2);
+   }
+   catch (string ex)
+   {
+      mLoaded = false; // Carry on without sound
+      return;
+   }
+
+   if (!mPaused)
+      SDL_PauseAudio(false);
+}
+/******************************************************************************
+ * Destructor: delete audio data
+ *****************************************************************************/
+AudioManager::~AudioManager()
+{
+   // Pause and lock audio to free resources (unless there is no device:
+   // none was opened, or adapt couldn't reopen it)
+   if (mLoaded)
    {
-      delete *iter;
+      SDL_PauseAudio(true);    
+      SDL_LockAudio();
    }
+
+   // Clean-up 
    for (map<string, Sound*>::iterator iter = mSoundMap.begin(); 
       iter != mSoundMap.end(); iter++)
    {
@@ -66,18 +146,20 @@ AudioManager::~AudioManager()
    }
 
    // Done, unlock and close SDL
-   SDL_UnlockAudio();
-     
-   SDL_CloseAudio();
+   if (mLoaded)
+   {
+      SDL_UnlockAudio();
+      SDL_CloseAudio();
+   }
 }
 
 /******************************************************************************
- * load: retrieves the PlaybackInfo for the given file. If the file has not
+ * load: retrieves the Sound for the given file. If the file has not
  *    yet been loaded, the method will attempt to load the file.
  *    INPUT : filename: name of the file to load
- *    OUTPUT: <return>: The PlaybackInfo associated with the file, or NULL
+ *    OUTPUT: <return>: The Sound, or NULL
  *****************************************************************************/
-PlaybackInfo* AudioManager::load(string filename, bool loop)
+Sound* AudioManager::load(const string &filename)
 {
    map<string, Sound*>::iterator iter = mSoundMap.find(filename);
    Sound* pSound = NULL;
@@ -104,7 +186,117 @@ PlaybackInfo* AudioManager::load(string filename, bool loop)
       }
    }
 
-   return pSound->getPlaybackInfo(loop);
+   return pSound;
+}
+
+/******************************************************************************
+ * isBusy: whether a voice is still playing what it was last given
+ *****************************************************************************/
+bool AudioManager::isBusy(int voice) const
+{
+   return mVoices[voice].pSound != NULL &&
+      mFinished[voice].load(memory_order_acquire) != mVoices[voice].generation;
+}
+
+/******************************************************************************
+ * findVoice: picks the voice for a new play, stealing one if need be
+ *    INPUT : pSound  : what is to be played
+ *            priority: how important it is
+ *    OUTPUT: <return>: the voice, or -1 if every voice is more important
+ *****************************************************************************/
+int AudioManager::findVoice(const Sound* pSound, int priority) const
+{
+   int count  = 0;  // voices playing this sound
+   int oldest = -1; // the oldest of them
+   int free   = -1;
+   int victim = -1; // the oldest of the least important voices
+
+   for (int i = 0; i < AUDIO_MAX_VOICES; i++)
+   {
+      if (!isBusy(i))
+      {
+         if (free == -1)
+            free = i;
+         continue;
+      }
+
+      const Voice &voice = mVoices[i];
+
+      if (voice.pSound == pSound)
+      {
+         count++;
+         if (oldest == -1 || voice.started < mVoices[oldest].started)
+            oldest = i;
+      }
+
+      if (voice.priority <= priority &&
+          (victim == -1 || voice.priority < mVoices[victim].priority ||
+           (voice.priority == mVoices[victim].priority && 
+            voice.started < mVoices[victim].started)))
+         victim = i;
+   }
+
+   if (count >= pSound->getLimit())
+      return oldest;
+   return free != -1 ? free : victim;
+}
+
+/******************************************************************************
+ * send: queues a command for the mixer, dropping it if the ring is full.
+ *    Waiting for room could mean waiting a whole callback, so a sound that 
+ *    can't be queued is simply not heard
+ *    INPUT : command : what the mixer should do
+ *    OUTPUT: <return>: whether it was queued
+ *****************************************************************************/
+bool AudioManager::send(const AudioCommand &command)
+{
+   if (!mLoaded)
+      return false; // No mixer to drain the ring
+
+   if (!mCommands.push(command))
+   {
+      mDropped++;
+      return false;
+   }
+
+   return true;
+}
+
+/******************************************************************************
+ * applyCommands: carries out every queued command (mixer only)
+ *****************************************************************************/
+void AudioManager::applyCommands()
+{
+   AudioCommand command;
+
+   while (mCommands.pop(command))
+   {
+      switch (command.type)
+      {
+      case AUDIO_PLAY:
+         // Whatever the voice was playing is cut off
+         mPlayback[command.voice].start(command.pSound, command.value != 0);
+         mPlaying[command.voice] = command.generation;
+         break;
+
+      case AUDIO_STOP:
+         if (mPlaying[command.voice] == command.generation)
+            mPlayback[command.voice].stop();
+         break;
+
+      case AUDIO_STOP_ALL:
+         for (int i = 0; i < AUDIO_MAX_VOICES; i++)
+         {
+            if (mPlayback[i].isPlaying())
+               mPlayback[i].stop();
+         }
+         break;
+
+      case AUDIO_VOLUME:
+         mMixVolume = command.value;
+         break;
+      }
+   }
 }
 
 /******************************************************************************
@@ -118,6 +310,9 @@ void AudioManager::setVolume(int volume)
       throw string("Volume out of range");
    }
    mVolume = volume;
+
+   AudioCommand command = { AUDIO_VOLUME, 0, 0, NULL, mVolume };
+   send(command);
 }
 
 /******************************************************************************
@@ -136,6 +331,25 @@ void AudioManager::adjustVolume(int increment)
    {
       mVolume = SDL_MIX_MAXVOLUME - 1;
    }
+
+   AudioCommand command = { AUDIO_VOLUME, 0, 0, NULL, mVolume };
+   send(command);
+}
+
+/******************************************************************************
+ * setLimit: sets how many voices may play a sound at once
+ *    INPUT: filename: name of the file
+ *           limit   : most voices at once
+ *****************************************************************************/
+void AudioManager::setLimit(const string &filename, int limit)
+{
+   if (!mLoaded)
+      return;
+
+   Sound* pSound = load(filename);
+
+   if (pSound != NULL)
+      pSound->setLimit(limit);
 }
 
 /******************************************************************************
@@ -144,21 +358,112 @@ void AudioManager::adjustVolume(int increment)
  *****************************************************************************/
 void AudioManager::pause(bool paused)
 {
+   if (!mLoaded)
+      return;
+
    SDL_PauseAudio(paused);
+   mPaused = paused;
+
+   // No callbacks come while paused, so the gap before the next one isn't
+   // a miss. Pausing waits for a running callback, so this is safe
+   if (paused)
+      mLastCallback = 0;
 }
 
 /***************************************************************************
  * play: plays the given file a single time through
- *    INPUT: filename: name of the file to play
+ *    INPUT : filename: name of the file to play
+ *            loop    : whether to play it until stopped
+ *            priority: which sounds it may take a voice from
+ *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
  **************************************************************************/
-void AudioManager::play(string filename, bool loop)
+VoiceHandle AudioManager::play(const string &filename, bool loop,
+                               AudioPriority priority)
 {
-   PlaybackInfo* pSound = load(filename, loop);
+   if (!mLoaded)
+      return AUDIO_NO_VOICE;
 
-   if (pSound != NULL)
+   Sound* pSound = load(filename);
+   if (pSound == NULL)
+      return AUDIO_NO_VOICE;
+
+   return start(pSound, loop, priority);
+}
+
+/***************************************************************************
+ * stream: plays the given file as it is read rather than loading it whole
+ *    (for music). The first call opens the file; later ones play it on from
+ *    where it has got to
+ *    INPUT : filename: name of the file to play
+ *            loop    : whether to start the file over when it ends
+ *            priority: which sounds it may take a voice from
+ *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
+ **************************************************************************/
+VoiceHandle AudioManager::stream(const string &filename, bool loop,
+                                 AudioPriority priority)
+{
+   if (!mLoaded)
+      return AUDIO_NO_VOICE;
+
+   map<string, Sound*>::iterator iter = mSoundMap.find(filename);
+   Sound* pSound;
+
+   if (iter != mSoundMap.end())
    {
-      mSoundList.push_back(pSound);
+      pSound = iter->second;
    }
+   else
+   {
+      StreamingSound* pStream = new StreamingSound(filename, &mAudioSpec, 
+                                                   loop);
+      mStreams.push_back(pStream);
+      mSoundMap.insert(std::pair<string, Sound*>(filename, pStream));
+      pSound = pStream;
+   }
+
+   return start(pSound, loop, priority);
+}
+
+/***************************************************************************
+ * getStreamUnderruns: the number of mixes that a stream's reader couldn't
+ *    keep up with, over every stream opened
+ *    OUTPUT: <return>: the total
+ **************************************************************************/
+int AudioManager::getStreamUnderruns() const
+{
+   int underruns = 0;
+   for (int i = 0; i < mStreams.size(); i++)
+      underruns += mStreams[i]->getUnderruns();
+
+   return underruns;
+}
+
+/***************************************************************************
+ * start: gives a sound a voice and has the mixer play it
+ *    INPUT : pSound  : what to play
+ *            loop    : whether to play it until stopped
+ *            priority: which sounds it may take a voice from
+ *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
+ **************************************************************************/
+VoiceHandle AudioManager::start(Sound* pSound, bool loop, 
+                                AudioPriority priority)
+{
+   int i = findVoice(pSound, priority);
+   if (i == -1)
+      return AUDIO_NO_VOICE;
+
+   Voice &voice = mVoices[i];
+   AudioCommand command = 
+      { AUDIO_PLAY, i, voice.generation + 1, pSound, loop };
+   if (!send(command))
+      return AUDIO_NO_VOICE;
+
+   voice.pSound   = pSound;
+   voice.priority = priority;
+   voice.started  = mPlays++;
+   voice.generation++;
+
+   return voice.generation * AUDIO_MAX_VOICES + i;
 }
 
 /******************************************************************************
@@ -166,31 +471,48 @@ void AudioManager::play(string filename, bool loop)
  *****************************************************************************/
 void AudioManager::stop()
 {
-   for (list<PlaybackInfo*>::iterator iter = mSoundList.begin();
-      iter != mSoundList.end();
-      iter++)
-   {
-      (*iter)->stop();
-   }
+   AudioCommand command = { AUDIO_STOP_ALL, 0, 0, NULL, 0 };
+   if (!send(command))
+      return;
+
+   for (int i = 0; i < AUDIO_MAX_VOICES; i++)
+      mVoices[i].pSound = NULL;
+}
+
+/******************************************************************************
+ * stop: stops one play of a sound (if it is still playing)
+ *    INPUT: handle: what play returned
+ *****************************************************************************/
+void AudioManager::stop(VoiceHandle handle)
+{
+   int      i          = handle % AUDIO_MAX_VOICES;
+   unsigned generation = handle / AUDIO_MAX_VOICES;
+
+   if (handle == AUDIO_NO_VOICE || !isBusy(i) || 
+       mVoices[i].generation != generation)
+      return; // Over already, or the voice has been given to another sound
+
+   AudioCommand command = { AUDIO_STOP, i, generation, NULL, 0 };
+   if (send(command))
+      mVoices[i].pSound = NULL; // Free now: later commands come after it
 }
 
 /***************************************************************************
- * stop: stops the given audio file from playing (thread-safe)
+ * stop: stops the given audio file from playing
  *    INPUT: filename: name of the file to stop
  **************************************************************************/
-void AudioManager::stop(std::string filename)
+void AudioManager::stop(const string &filename)
 {
-   PlaybackInfo* temp = load(filename, false);
+   if (!mLoaded)
+      return;
 
-   // Search for PlaybackInfo's that share the same Sound instance
-   for (list<PlaybackInfo*>::iterator iter = mSoundList.begin();
-      iter != mSoundList.end(); iter++)
+   Sound* pSound = load(filename);
+
+   for (int i = 0; i < AUDIO_MAX_VOICES; i++)
    {
-      if (*temp == *iter)
-         (*iter)->stop();
+      if (pSound != NULL && mVoices[i].pSound == pSound && isBusy(i))
+         stop(mVoices[i].generation * AUDIO_MAX_VOICES + i);
    }
-
-   delete temp;
 }
 
 /******************************************************************************
@@ -215,25 +537,66 @@ void AudioManager::mixAudio(Uint8 *audio, int length)
    if (!mLoaded)
       return; // Sound must have failed to initialize
 
-   // Prepare audio buffer
-   memset(audio, 0, length);
-   
-   // Play all the sounds in the list
-   for (list<PlaybackInfo*>::iterator iter = mSoundList.begin(); 
-      iter != mSoundList.end(); )
+   Uint64 start = SDL_GetPerformanceCounter();
+
+   // Catch up with the game thread
+   applyCommands();
+
+   // Sum every voice into the accumulator and clamp once at the end. A 
+   // request bigger than the accumulator is mixed a piece at a time
+   for (int offset = 0; offset < length; )
    {
-      PlaybackInfo* pSound = *iter;
-      
-      pSound->play(audio, length, mVolume);
+      int chunk = min(length - offset, (int)mMix.size() * 2);
+      fill(mMix.begin(), mMix.begin() + chunk / 2, 0);
 
-      if (!pSound->isPlaying())
-      {
-         delete *iter;
-         iter = mSoundList.erase(iter);
-      }
-      else
+      // Mix every voice, telling the game thread about those that finish
+      for (int i = 0; i < AUDIO_MAX_VOICES; i++)
       {
-         iter++; // ... Avoid incrementing after deletes
+         PlaybackInfo &voice = mPlayback[i];
+         if (!voice.isPlaying())
+            continue;
+
+         voice.play(mMix.data(), chunk, mMixVolume);
+
+         if (!voice.isPlaying())
+            mFinished[i].store(mPlaying[i], memory_order_release);
       }
+
+      saturate((Sint16*)(audio + offset), mMix.data(), chunk / 2);
+      offset += chunk;
+   }
+
+   time(start, SDL_GetPerformanceCounter());
+}
+
+/******************************************************************************
+ * time: records how long a callback took and whether it missed its deadline
+ *    (mixer only). A callback misses when mixing took longer than the 
+ *    sound it made lasts, or when it started more than AUDIO_LATE_PERIODS
+ *    buffers after the one before: the device can't have had that much 
+ *    queued, so it played silence in between
+ *    INPUT: start, end: performance counter before and after mixing
+ *****************************************************************************/
+void AudioManager::time(Uint64 start, Uint64 end)
+{
+   Uint64 spent = end - start;
+   bool   late  = mLastCallback != 0 &&
+                  start - mLastCallback > AUDIO_LATE_PERIODS * mDeadline;
+
+   if (late || spent > mDeadline)
+   {
+      mUnderruns++;
+      mMisses++;
    }
+   mLastCallback = start;
+
+   unsigned us = (unsigned)(spent * 1000000 / SDL_GetPerformanceFrequency());
+   mCallbackTotal += us;
+   mCallbacks++;
+
+   mCallbackTime.store(us, memory_order_relaxed);
+   mCallbackAvg.store((unsigned)(mCallbackTotal / mCallbacks), 
+                      memory_order_relaxed);
+   if (us > mCallbackMax.load(memory_order_relaxed))
+      mCallbackMax.store(us, memory_order_relaxed);
 }
\ No newline at end of file
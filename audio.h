@@ -5,33 +5,188 @@
 #define AUDIO_H
 
 #include "sound.h"
+#include "ring.h"
 #include <map>
+#include <vector>
 #include <string>
-#include <list>
+#include <atomic>
 #include <SDL2/SDL.h>
 
+class StreamingSound;
+
+#define AUDIO_QUEUE_SIZE 256 // commands waiting for the mixer (power of 2)
+#define AUDIO_MAX_VOICES 32  // sounds that can play at once
+
+#define AUDIO_FREQUENCY       44100
+#define AUDIO_MIN_SAMPLES     256  // smallest buffer: ~6 ms at 44.1 kHz
+#define AUDIO_MAX_SAMPLES     4096 // largest buffer: ~93 ms
+#define AUDIO_DEFAULT_LATENCY 25   // ms: a buffer of 1024 samples
+#define AUDIO_LATE_PERIODS    2    // buffers between callbacks that mean the
+                                   // device ran out of sound
+#define AUDIO_ADAPT_MISSES    3    // misses at one buffer size before the
+                                   // adaptive mode doubles it
+
+/***************************************************************************
+ * AudioPriority: which sounds give up their voice when all are in use
+ **************************************************************************/
+enum AudioPriority
+{
+   AUDIO_PRIORITY_LOW,    // rapid, repeated effects
+   AUDIO_PRIORITY_NORMAL,
+   AUDIO_PRIORITY_HIGH    // music
+};
+
+/***************************************************************************
+ * VoiceHandle: names one play of a sound: the voice it was given and how
+ *    many times that voice had been given out before, so a handle kept 
+ *    after its voice was reused does nothing
+ **************************************************************************/
+typedef unsigned VoiceHandle;
+
+#define AUDIO_NO_VOICE 0 // play() found no voice
+
+/***************************************************************************
+ * AudioCommand: a request from the game thread to the mixer
+ **************************************************************************/
+enum AudioCommandType
+{
+   AUDIO_PLAY,     // start pSound on voice (value: whether to loop)
+   AUDIO_STOP,     // stop voice, if it is still playing generation
+   AUDIO_STOP_ALL,
+   AUDIO_VOLUME    // mix at value from now on
+};
+
+struct AudioCommand
+{
+   AudioCommandType type;
+   int              voice;
+   unsigned         generation;
+   const Sound*     pSound;
+   int              value;
+};
+
 /***************************************************************************
  * AudioManager: manages loading and playing audio files. Files are loaded
  *    into memory on-demand and indexed by filename. Sounds can be played 
- *    a single time or set as the loop background sound
+ *    a single time or set as the loop background sound. 
+ *
+ *    Sounds play on a fixed set of voices. The game thread decides which 
+ *    voice each play gets: a free one if there is one, otherwise the oldest
+ *    voice of the same sound if that sound is at its limit, otherwise the 
+ *    oldest voice of the lowest priority no higher than the new sound's. 
+ *    The game thread never touches what the mixer is playing: play, stop 
+ *    and the volume are queued as commands in a lock-free ring that the 
+ *    mixer drains at the start of each callback, and the mixer reports the
+ *    voices that finish back through mFinished, so neither thread ever 
+ *    waits for the other
+ *
+ *    The buffer size sets the latency: a sound starts at most one buffer
+ *    after play() is called. The mixer times every callback against the 
+ *    buffer's length (its deadline) and counts a miss when mixing took 
+ *    longer than that or when the callback came so late that the device
+ *    must have run dry. In adaptive mode the game thread doubles the
+ *    buffer (up to AUDIO_MAX_SAMPLES) once the misses pile up
  **************************************************************************/
 class AudioManager
 {
 private:
 
+   /***************************************************************************
+    * Voice: what the game thread knows about a voice it gave out
+    **************************************************************************/
+   struct Voice
+   {
+      const Sound* pSound;     // NULL when free
+      int          priority;
+      unsigned     generation; // plays given this voice so far
+      unsigned     started;    // mPlays when given out, for finding the oldest
+   };
+
    bool                     mLoaded;
-   int                      mVolume;
+   bool                     mPaused;
+   bool                     mAdaptive;    // grow the buffer on misses
+   int                      mVolume;      // game thread's copy
+   int                      mDropped;     // commands lost to a full ring
+   unsigned                 mPlays;
    SDL_AudioSpec            mAudioSpec;
-   std::map<std::string, Sound*> mSoundMap;
-   std::list<PlaybackInfo*> mSoundList;   
+   std::map<std::string, Sound*> mSoundMap; // game thread only
+   std::vector<StreamingSound*> mStreams;   // game thread only: the ones
+                                            // in mSoundMap that stream
+   Voice                    mVoices[AUDIO_MAX_VOICES];    // game thread only
+   Ring<AudioCommand, AUDIO_QUEUE_SIZE> mCommands;
+   std::atomic<unsigned>    mFinished[AUDIO_MAX_VOICES];  // last generation
+                                                          // each voice ended
+   PlaybackInfo             mPlayback[AUDIO_MAX_VOICES];  // mixer only
+   unsigned                 mPlaying[AUDIO_MAX_VOICES];   // mixer only
+   std::vector<int>         mMix;         // mixer only: the accumulator
+   int                      mMixVolume;                   // mixer only
+
+   // Callback timing: kept by the mixer, reset by the game thread only
+   // while the device is paused or closed
+   Uint64                   mDeadline;     // buffer length (counter ticks)
+   Uint64                   mLastCallback; // when it last started, or 0
+   Uint64                   mCallbackTotal;
+   unsigned                 mCallbacks;
+   std::atomic<unsigned>    mCallbackTime; // microseconds: the last one
+   std::atomic<unsigned>    mCallbackAvg;
+   std::atomic<unsigned>    mCallbackMax;
+   std::atomic<int>         mUnderruns;    // every miss
+   std::atomic<int>         mMisses;       // misses at this buffer size
+
+   /***************************************************************************
+    * open: opens the audio device (paused) and resets the timing
+    *    INPUT: samples: buffer size in sample frames
+    **************************************************************************/
+   void open(int samples);
+
+   /***************************************************************************
+    * time: records how long a callback took and whether it missed its 
+    *    deadline (mixer only)
+    *    INPUT: start, end: performance counter before and after mixing
+    **************************************************************************/
+   void time(Uint64 start, Uint64 end);
 
    /***************************************************************************
-    * load: retrieves the PlaybackInfo for the given file. If the file has not
+    * load: retrieves the Sound for the given file. If the file has not
     *    yet been loaded, the method will attempt to load the file.
     *    INPUT : filename: name of the file to load
-    *    OUTPUT: <return>: The PlaybackInfo associated with the file, or NULL
+    *    OUTPUT: <return>: The Sound, or NULL
+    **************************************************************************/
+   Sound* load(const std::string &filename);
+
+   /***************************************************************************
+    * start: gives a sound a voice and has the mixer play it
+    *    INPUT : pSound  : what to play
+    *            loop    : whether to play it until stopped
+    *            priority: which sounds it may take a voice from
+    *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
+    **************************************************************************/
+   VoiceHandle start(Sound* pSound, bool loop, AudioPriority priority);
+
+   /***************************************************************************
+    * isBusy: whether a voice is still playing what it was last given
+    **************************************************************************/
+   bool isBusy(int voice) const;
+
+   /***************************************************************************
+    * findVoice: picks the voice for a new play, stealing one if need be
+    *    INPUT : pSound  : what is to be played
+    *            priority: how important it is
+    *    OUTPUT: <return>: the voice, or -1 if every voice is more important
     **************************************************************************/
-   PlaybackInfo* load(std::string filename, bool loop = false);
+   int findVoice(const Sound* pSound, int priority) const;
+
+   /***************************************************************************
+    * send: queues a command for the mixer, dropping it if the ring is full
+    *    INPUT : command : what the mixer should do
+    *    OUTPUT: <return>: whether it was queued
+    **************************************************************************/
+   bool send(const AudioCommand &command);
+
+   /***************************************************************************
+    * applyCommands: carries out every queued command (mixer only)
+    **************************************************************************/
+   void applyCommands();
 
    /***************************************************************************
     * mixAudio: fills the audio stream with a mix of all the current sounds
@@ -51,7 +206,18 @@ private:
 
 public:
 
-   AudioManager();
+   /***************************************************************************
+    * AudioManager:
+    *    INPUT: enabled : when false no audio device is opened and every
+    *                     sound request is silently ignored (headless mode)
+    *           latency : most milliseconds of buffering wanted. The buffer
+    *                     is the largest power of two that fits, within
+    *                     AUDIO_MIN_SAMPLES and AUDIO_MAX_SAMPLES
+    *           adaptive: whether to grow the buffer when callbacks miss
+    *                     their deadline (see adapt)
+    **************************************************************************/
+   AudioManager(bool enabled = true, int latency = AUDIO_DEFAULT_LATENCY,
+                bool adaptive = true);
 
    ~AudioManager();
 
@@ -67,6 +233,14 @@ public:
     **************************************************************************/
    void adjustVolume(int increment);
 
+   /***************************************************************************
+    * setLimit: sets how many voices may play a sound at once 
+    *    (AUDIO_SOUND_LIMIT unless set)
+    *    INPUT: filename: name of the file
+    *           limit   : most voices at once
+    **************************************************************************/
+   void setLimit(const std::string &filename, int limit);
+
    /***************************************************************************
     * pause: sets the pause status of all sounds
     *    INPUT: paused: whether or not to pause all of the sounds
@@ -75,9 +249,25 @@ public:
 
    /***************************************************************************
     * play: plays the given file a single time through
-    *    INPUT: filename: name of the file to play
+    *    INPUT : filename: name of the file to play
+    *            loop    : whether to play it until stopped
+    *            priority: which sounds it may take a voice from
+    *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
     **************************************************************************/
-   void play(std::string filename, bool loop = false);
+   VoiceHandle play(const std::string &filename, bool loop = false,
+                    AudioPriority priority = AUDIO_PRIORITY_NORMAL);
+
+   /***************************************************************************
+    * stream: plays the given file as it is read rather than loading it 
+    *    whole (for music). The first call opens the file; later ones play it
+    *    on from where it has got to
+    *    INPUT : filename: name of the file to play
+    *            loop    : whether to start the file over when it ends
+    *            priority: which sounds it may take a voice from
+    *    OUTPUT: <return>: the voice playing it, or AUDIO_NO_VOICE
+    **************************************************************************/
+   VoiceHandle stream(const std::string &filename, bool loop = false,
+                      AudioPriority priority = AUDIO_PRIORITY_NORMAL);
 
    /***************************************************************************
     * stop: stops all the audio
@@ -85,10 +275,63 @@ public:
    void stop();
 
    /***************************************************************************
-    * stop: stops the given audio file from playing (thread-safe)
+    * stop: stops one play of a sound (if it is still playing)
+    *    INPUT: handle: what play returned
+    **************************************************************************/
+   void stop(VoiceHandle handle);
+
+   /***************************************************************************
+    * stop: stops the given audio file from playing
     *    INPUT: filename: name of the file to stop
     **************************************************************************/
-   void stop(std::string filename);
+   void stop(const std::string &filename);
+
+   /***************************************************************************
+    * adapt: in adaptive mode, reopens the device with twice the buffer once
+    *    AUDIO_ADAPT_MISSES callbacks have missed their deadline at the 
+    *    current size. Call it regularly from the game thread; what is 
+    *    playing carries on after a short gap
+    **************************************************************************/
+   void adapt();
+
+   /***************************************************************************
+    * getDropped: the number of commands lost because the mixer fell behind
+    **************************************************************************/
+   int getDropped() const { return mDropped; }
+
+   /***************************************************************************
+    * getSamples: the buffer size in sample frames (0 without a device)
+    **************************************************************************/
+   int getSamples() const { return mLoaded ? mAudioSpec.samples : 0; }
+
+   /***************************************************************************
+    * getDeadline: how long a callback has (the buffer's length) in 
+    *    microseconds
+    **************************************************************************/
+   unsigned getDeadline() const
+   {
+      return (unsigned)((Uint64)getSamples() * 1000000 / AUDIO_FREQUENCY);
+   }
+
+   /***************************************************************************
+    * getCallbackTime, getCallbackAvg, getCallbackMax: microseconds spent 
+    *    mixing in the last callback, and on average and at most since the 
+    *    buffer size was last set
+    **************************************************************************/
+   unsigned getCallbackTime() const { return mCallbackTime; }
+   unsigned getCallbackAvg()  const { return mCallbackAvg;  }
+   unsigned getCallbackMax()  const { return mCallbackMax;  }
+
+   /***************************************************************************
+    * getUnderruns: the number of callbacks that missed their deadline
+    **************************************************************************/
+   int getUnderruns() const { return mUnderruns; }
+
+   /***************************************************************************
+    * getStreamUnderruns: the number of mixes that a stream's reader couldn't
+    *    keep up with, over every stream opened
+    **************************************************************************/
+   int getStreamUnderruns() const;
 };
 
-#endif
\ No newline at end of file
+#endif
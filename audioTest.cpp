@@ -1,11 +1,13 @@
 /******************************************************************************
  * audioTest.cpp: this is a driver program for testing functionality of the
- *    audio manager class. It can play or loop a given WAV file.
+ *    audio manager class. It can play or loop a given WAV file. Usage: 
+ *    audioTest [latency in ms]
  *****************************************************************************/
 #include "sound.h"
 #include "audio.h"
 #include <string>
 #include <iostream>
+#include <stdlib.h>
 using namespace std;
 
 /******************************************************************************
@@ -25,7 +27,8 @@ string prompt(string text = "file: ")
  *****************************************************************************/
 int main(int argc, char **argv)
 {  
-    AudioManager manager;
+    AudioManager manager(true, 
+                         argc > 1 ? atoi(argv[1]) : AUDIO_DEFAULT_LATENCY);
 
     cout << "Audio test (enter 'help' for options)\n\n";
 
@@ -44,6 +47,23 @@ int main(int argc, char **argv)
           {
              manager.play(prompt(), true);
           }
+          else if (buff == "stream")
+          {
+             manager.stream(prompt(), true);
+          }
+          else if (buff == "stats")
+          {
+             manager.adapt();
+             cout << "buffer:    " << manager.getSamples() << " samples\n"
+                  << "deadline:  " << manager.getDeadline() << " us\n"
+                  << "callback:  " << manager.getCallbackTime() << " us (avg "
+                  << manager.getCallbackAvg() << ", max " 
+                  << manager.getCallbackMax() << ")\n"
+                  << "underruns: " << manager.getUnderruns() << "\n"
+                  << "streams:   " << manager.getStreamUnderruns() 
+                  << " underruns\n"
+                  << "dropped:   " << manager.getDropped() << " commands\n";
+          }
           else if (buff == "quit")
           {
              break;
@@ -57,7 +77,9 @@ int main(int argc, char **argv)
              cout << "play:   play the specified file a single time\n"
                   << "help:   display this help menu\n"
                   << "loop:   loop the specified file\n"
+                  << "stream: loop the specified file, reading it as it plays\n"
                   << "stop:   stops the specified sound\n"
+                  << "stats:  show the buffer size, callback timing and losses\n"
                   << "quit:   safely quit the program\n"
                   << "+   :   increase volume\n"
                   << "-   :   decrease volume\n";
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * batch.cpp: implements the SpriteBatch
+ *****************************************************************************/
+#include "batch.h"
+#include <algorithm>
+using namespace std;
+
+/******************************************************************************
+ * add: queues a quad
+ *    INPUT: texture   : OpenGL texture
+ *           corners   : x, y of the corners, counterclockwise from the one at
+ *                       the bottom left of the image
+ *           uMin, uMax: texture coordinates of the left and right edges
+ *           vTop, vBot: texture coordinates of the top and bottom edges
+ *           alpha     : opacity, 0 to 1
+ *****************************************************************************/
+void SpriteBatch::add(GLuint texture, const float corners[8], 
+                      float uMin, float uMax, float vTop, float vBot, 
+                      float alpha)
+{
+   Quad quad;
+   quad.texture = texture;
+   quad.index   = mQuads.size();
+   mQuads.push_back(quad);
+
+   mVertices.insert(mVertices.end(), corners, corners + 8);
+
+   float texCoords[8] = 
+   { 
+      uMin, vBot,  uMax, vBot,  uMax, vTop,  uMin, vTop 
+   };
+   mTexCoords.insert(mTexCoords.end(), texCoords, texCoords + 8);
+
+   for (int i = 0; i < 4; i++)
+   {
+      mColors.push_back(1);
+      mColors.push_back(1);
+      mColors.push_back(1);
+      mColors.push_back(alpha);
+   }
+}
+
+/******************************************************************************
+ * flush: draws everything queued and empties the batch
+ *****************************************************************************/
+void SpriteBatch::flush()
+{
+   mDrawCalls = 0;
+
+   if (mQuads.empty())
+      return;
+
+   sort(mQuads.begin(), mQuads.end());
+
+   // Gather the quads in texture order, so each texture is one range
+   mSortedVertices.resize(mVertices.size());
+   mSortedTexCoords.resize(mTexCoords.size());
+   mSortedColors.resize(mColors.size());
+
+   for (int i = 0; i < mQuads.size(); i++)
+   {
+      int from = mQuads[i].index * 8;
+      copy(&mVertices[from],  &mVertices[from] + 8,  &mSortedVertices[i * 8]);
+      copy(&mTexCoords[from], &mTexCoords[from] + 8, &mSortedTexCoords[i * 8]);
+      copy(&mColors[from * 2], &mColors[from * 2] + 16, &mSortedColors[i * 16]);
+   }
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+   glEnableClientState(GL_COLOR_ARRAY);
+   glVertexPointer(2, GL_FLOAT, 0, mSortedVertices.data());
+   glTexCoordPointer(2, GL_FLOAT, 0, mSortedTexCoords.data());
+   glColorPointer(4, GL_FLOAT, 0, mSortedColors.data());
+
+   for (int begin = 0; begin < mQuads.size(); )
+   {
+      int end = begin + 1;
+      while (end < mQuads.size() && 
+             mQuads[end].texture == mQuads[begin].texture)
+         end++;
+
+      glBindTexture(GL_TEXTURE_2D, mQuads[begin].texture);
+      glDrawArrays(GL_QUADS, begin * 4, (end - begin) * 4);
+      mDrawCalls++;
+
+      begin = end;
+   }
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+
+   // The current color is left undefined by the color array
+   glColor4f(1, 1, 1, 1);
+
+   mQuads.clear();
+   mVertices.clear();
+   mTexCoords.clear();
+   mColors.clear();
+}
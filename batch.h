@@ -0,0 +1,73 @@
+/******************************************************************************
+ * batch.h: defines the SpriteBatch, which collects the textured quads of a
+ *    frame and draws them with one call per texture
+ *****************************************************************************/
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+#include <vector>
+
+/******************************************************************************
+ * SpriteBatch: quads are added with their corners already transformed, then
+ *    flush sorts them by texture and submits each texture's quads as one 
+ *    vertex array. Quads with the same texture keep the order they were 
+ *    added in; anything that must end up on top of everything added so far
+ *    (a menu over the game) needs a flush in between. The arrays keep their
+ *    size between frames, so a steady scene allocates nothing
+ *****************************************************************************/
+class SpriteBatch
+{
+private:
+
+   struct Quad
+   {
+      GLuint texture;
+      int    index;    // order added (the quad's place in the arrays)
+
+      bool operator < (const Quad &rhs) const
+      {
+         return texture < rhs.texture || 
+               (texture == rhs.texture && index < rhs.index);
+      }
+   };
+
+   std::vector<Quad>  mQuads;
+   std::vector<float> mVertices;  // 8 per quad: x, y of each corner
+   std::vector<float> mTexCoords; // 8 per quad: u, v of each corner
+   std::vector<float> mColors;    // 16 per quad: r, g, b, a of each corner
+   std::vector<float> mSortedVertices;
+   std::vector<float> mSortedTexCoords;
+   std::vector<float> mSortedColors;
+   int                mDrawCalls; // during the last flush
+
+public:
+
+   SpriteBatch() : mDrawCalls(0) { }
+
+   /***************************************************************************
+    * add: queues a quad
+    *    INPUT: texture   : OpenGL texture
+    *           corners   : x, y of the corners, counterclockwise from the one
+    *                       at the bottom left of the image
+    *           uMin, uMax: texture coordinates of the left and right edges
+    *           vTop, vBot: texture coordinates of the top and bottom edges
+    *           alpha     : opacity, 0 to 1
+    **************************************************************************/
+   void add(GLuint texture, const float corners[8], 
+            float uMin, float uMax, float vTop, float vBot, float alpha = 1);
+
+   /***************************************************************************
+    * flush: draws everything queued and empties the batch
+    **************************************************************************/
+   void flush();
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   int getQuads()     const { return mQuads.size(); }
+   int getDrawCalls() const { return mDrawCalls;    }
+};
+
+#endif
@@ -0,0 +1,269 @@
+/******************************************************************************
+ * bench.cpp: runs scripted stress scenarios on a headless environment and
+ *    reports the p50, p99 and max simulation tick time and the number of 
+ *    heap allocations per tick of each. Every run uses the same seed 
+ *    (BENCH_SEED) unless --seed is given, so runs can be compared.
+ *    Usage: bench [ticks] [--json] [--workers=N] [--seed=N]
+ *****************************************************************************/
+#include "environment.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <new>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+using namespace std;
+
+#define BENCH_SEED "1" // seed used when --seed isn't given
+
+/******************************************************************************
+ * Allocation counting: every operator new in the process goes through here
+ *****************************************************************************/
+static atomic<long> sAllocations(0);
+
+void* operator new(size_t size)
+{
+   sAllocations++;
+
+   void* p = malloc(size ? size : 1);
+   if (p == NULL)
+      throw bad_alloc();
+   return p;
+}
+
+void operator delete(void* p) noexcept
+{
+   free(p);
+}
+
+/******************************************************************************
+ * Result: the measurements of one scenario
+ *****************************************************************************/
+struct Result
+{
+   string name;
+   int    ticks;
+   int    entities;        // at the end of the run
+   double p50;             // microseconds
+   double p99;
+   double max;
+   double allocsPerTick;
+};
+
+/******************************************************************************
+ * Scenario: puts the environment in its starting state (setup) and keeps it
+ *    there between ticks (feed, may be NULL)
+ *****************************************************************************/
+struct Scenario
+{
+   const char* name;
+   void (*setup)(Environment* pEnvironment);
+   void (*feed)(Environment* pEnvironment);
+};
+
+/******************************************************************************
+ * randomVector: somewhere on the screen, drifting at up to speed
+ *****************************************************************************/
+Vector randomVector(Environment* pEnvironment, int speed)
+{
+   Random* pRandom = pEnvironment->getRandom();
+   return Vector(pRandom->nextFloat(0, pEnvironment->getXMax()),
+                 pRandom->nextFloat(0, pEnvironment->getYMax()),
+                 pRandom->nextFloat(-speed, speed),
+                 pRandom->nextFloat(-speed, speed));
+}
+
+/******************************************************************************
+ * Scenarios
+ *    rocks     : 10k drifting large rocks
+ *    bullets   : a barrage kept at 1k bullets, fired into 100 large rocks
+ *    saucers   : a swarm of 50 saucers firing missiles
+ *    explosions: 10k explosions, replaced as they burn out
+ *****************************************************************************/
+void setupRocks(Environment* pEnvironment)
+{
+   for (int i = 0; i < 10000; i++)
+      new LargeRock(pEnvironment, randomVector(pEnvironment, 30));
+   pEnvironment->addRockNum(10000);
+}
+
+void setupBullets(Environment* pEnvironment)
+{
+   for (int i = 0; i < 100; i++)
+      new LargeRock(pEnvironment, randomVector(pEnvironment, 30));
+   pEnvironment->addRockNum(100);
+}
+
+void feedBullets(Environment* pEnvironment)
+{
+   // Counted in the store: missiles share Bullet's pool
+   EntityStore* pEntities = pEnvironment->getEntities();
+   int          bullets   = 0;
+
+   for (int i = 0; i < pEntities->size(); i++)
+   {
+      if (pEntities->category(i) == CAT_BULLET)
+         bullets++;
+   }
+
+   for (; bullets < 1000; bullets++)
+   {
+      new Bullet(pEnvironment, randomVector(pEnvironment, 0), 
+                 pEnvironment->getRandom()->nextFloat(0, 360));
+   }
+}
+
+void setupSaucers(Environment* pEnvironment)
+{
+   for (int i = 0; i < 50; i++)
+      new Saucer(pEnvironment, randomVector(pEnvironment, 20));
+}
+
+static const string EXPLOSION_TEXTURE = SPR("explosion-orange");
+
+void feedExplosions(Environment* pEnvironment)
+{
+   while (Explosion::sPool.getLive() < 10000)
+      new Explosion(pEnvironment, randomVector(pEnvironment, 0), 
+                    EXPLOSION_TEXTURE);
+}
+
+static const Scenario SCENARIOS[] =
+{
+   { "rocks",      setupRocks,     NULL           },
+   { "bullets",    setupBullets,   feedBullets    },
+   { "saucers",    setupSaucers,   NULL           },
+   { "explosions", feedExplosions, feedExplosions }
+};
+
+/******************************************************************************
+ * percentile: the value below which the given fraction of the sorted 
+ *    samples fall
+ *****************************************************************************/
+double percentile(const vector<double> &sorted, double fraction)
+{
+   int i = (int)(fraction * sorted.size());
+   return sorted[min(i, (int)sorted.size() - 1)];
+}
+
+/******************************************************************************
+ * run: times a scenario tick by tick
+ *****************************************************************************/
+Result run(const Scenario &scenario, int ticks, int argc, char* argv[])
+{
+   Environment environment(argc, argv, true);
+   scenario.setup(&environment);
+
+   vector<double> times;
+   times.reserve(ticks);
+
+   long allocations = 0;
+   for (int i = 0; i < ticks; i++)
+   {
+      if (scenario.feed)
+         scenario.feed(&environment);
+
+      long before = sAllocations;
+      times.push_back(environment.simulate(1) * 1e6);
+      allocations += sAllocations - before;
+   }
+
+   sort(times.begin(), times.end());
+
+   Result result;
+   result.name          = scenario.name;
+   result.ticks         = ticks;
+   result.entities      = environment.getEntityCount();
+   result.p50           = percentile(times, 0.50);
+   result.p99           = percentile(times, 0.99);
+   result.max           = times.back();
+   result.allocsPerTick = (double)allocations / ticks;
+   return result;
+}
+
+/******************************************************************************
+ * main: runs every scenario and prints a table or JSON
+ *****************************************************************************/
+int main(int argc, char* argv[])
+{
+   int  ticks  = 2000;
+   bool json   = false;
+   bool seeded = false;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "--json") == 0)
+         json = true;
+      else if (strncmp(argv[i], "--seed=", 7) == 0)
+         seeded = true;
+      else if (argv[i][0] != '-')
+         ticks = atoi(argv[i]);
+   }
+
+   // Without a seed the Environment would pick one from the clock, and no
+   // two runs would replay the same workload
+   static char seedOption[] = "--seed=" BENCH_SEED;
+   vector<char*> args(argv, argv + argc);
+   if (!seeded)
+      args.push_back(seedOption);
+
+   vector<Result> results;
+
+   try
+   {
+      for (int i = 0; i < (int)(sizeof(SCENARIOS) / sizeof(SCENARIOS[0])); 
+           i++)
+      {
+         results.push_back(run(SCENARIOS[i], ticks, (int)args.size(), 
+                               args.data()));
+      }
+   }
+   catch (string ex)
+   {
+      cerr << ex << endl;
+      return 1;
+   }
+
+   cout << fixed << setprecision(1);
+
+   if (json)
+   {
+      cout << "{\"scenarios\": [";
+      for (int i = 0; i < (int)results.size(); i++)
+      {
+         cout << (i ? ",\n  " : "\n  ")
+              << "{\"name\": \""         << results[i].name     << "\""
+              << ", \"ticks\": "         << results[i].ticks
+              << ", \"entities\": "      << results[i].entities
+              << ", \"p50_us\": "        << results[i].p50
+              << ", \"p99_us\": "        << results[i].p99
+              << ", \"max_us\": "        << results[i].max
+              << ", \"allocs_per_tick\": " << results[i].allocsPerTick 
+              << "}";
+      }
+      cout << "\n]}\n";
+   }
+   else
+   {
+      cout << setw(10) << "scenario" << setw(8)  << "ticks"
+           << setw(10) << "entities" << setw(12) << "p50 (us)"
+           << setw(12) << "p99 (us)" << setw(12) << "max (us)"
+           << setw(14) << "allocs/tick" << endl;
+
+      for (int i = 0; i < (int)results.size(); i++)
+      {
+         cout << setw(10) << results[i].name 
+              << setw(8)  << results[i].ticks
+              << setw(10) << results[i].entities
+              << setw(12) << results[i].p50
+              << setw(12) << results[i].p99
+              << setw(12) << results[i].max
+              << setw(14) << results[i].allocsPerTick << endl;
+      }
+   }
+
+   return 0;
+}
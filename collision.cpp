@@ -0,0 +1,58 @@
+/******************************************************************************
+ * collision.cpp: implements the collision detection pass
+ *****************************************************************************/
+#include "collision.h"
+#include <algorithm>
+using namespace std;
+
+// The matrix is symmetric, and rocks don't collide with each other
+static_assert(canCollide(CAT_BULLET, CAT_ROCK) && 
+              canCollide(CAT_ROCK, CAT_BULLET), "bullets hit rocks");
+static_assert(!canCollide(CAT_ROCK, CAT_ROCK), "rocks pass through rocks");
+static_assert(collisionMask(CAT_EFFECT) == 0, "effects never collide");
+
+/******************************************************************************
+ * findContacts: narrowphase. Appends each candidate pair that can interact
+ *    and whose collision circles overlap to the contact list
+ *    INPUT : store     : entity positions and radii
+ *            candidates: broadphase pairs (see SpatialGrid::findPairs)
+ *            begin, end: range of candidates to test
+ *    OUTPUT: contacts  : the overlapping pairs, appended
+ *****************************************************************************/
+void findContacts(const EntityStore &store,
+                  const vector<pair<int, int> > &candidates,
+                  int begin, int end, vector<Contact> &contacts)
+{
+   for (int i = begin; i < end; i++)
+   {
+      int a = candidates[i].first;
+      int b = candidates[i].second;
+
+      // Layer filter: skip pairs the matrix has no rule for
+      if (!canCollide(store.category(a), store.category(b)))
+         continue;
+
+      // Compare squared distances, no need for the square root
+      float x     = store.x(b) - store.x(a);
+      float y     = store.y(b) - store.y(a);
+      float reach = store.radius(a) + store.radius(b);
+
+      if (x * x + y * y <= reach * reach)
+      {
+         Contact contact;
+         contact.a = min(a, b);
+         contact.b = max(a, b);
+         contacts.push_back(contact);
+      }
+   }
+}
+
+/******************************************************************************
+ * sortContacts: puts the contacts in canonical order and drops duplicates
+ *    INPUT/OUTPUT: contacts: the contact list
+ *****************************************************************************/
+void sortContacts(vector<Contact> &contacts)
+{
+   sort(contacts.begin(), contacts.end());
+   contacts.erase(unique(contacts.begin(), contacts.end()), contacts.end());
+}
@@ -0,0 +1,211 @@
+/******************************************************************************
+ * collision.h: defines the collision matrix, which says which categories of
+ *    entities interact and how, and the contact list produced by the 
+ *    collision detection pass and consumed by the collision resolution pass
+ *****************************************************************************/
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "store.h"
+#include <vector>
+#include <utility>
+
+/******************************************************************************
+ * Forward declarations
+ *****************************************************************************/
+class Environment;
+class Moveable;
+
+/******************************************************************************
+ * CollisionHandler: applies a collision rule to two touching entities
+ *****************************************************************************/
+typedef void (*CollisionHandler)(Environment* pEnvironment, 
+                                 Moveable* m1, Moveable* m2);
+
+/******************************************************************************
+ * CollisionRule: what happens when an entity of category A touches one of 
+ *    category B (A <= B). Pairs without a rule never interact, and are 
+ *    dropped before any distance is computed. Rules are declared with 
+ *    COLLISION_RULE below and their resolve is defined in environment.cpp
+ *****************************************************************************/
+template <int A, int B>
+struct CollisionRule
+{
+   static const bool INTERACTS = false;
+   static void resolve(Environment*, Moveable*, Moveable*) { }
+};
+
+#define COLLISION_RULE(A, B)                                                  \
+   template <>                                                                \
+   struct CollisionRule<A, B>                                                 \
+   {                                                                          \
+      static const bool INTERACTS = true;                                     \
+      static void resolve(Environment* pEnvironment,                          \
+                          Moveable* m1, Moveable* m2);                        \
+   };
+
+COLLISION_RULE(CAT_BULLET,  CAT_ROCK)   // bullet hits rock
+COLLISION_RULE(CAT_BULLET,  CAT_SAUCER) // bullet hits saucer
+COLLISION_RULE(CAT_MISSILE, CAT_SHIP)   // missile hits ship
+COLLISION_RULE(CAT_ROCK,    CAT_SHIP)   // rock hits ship
+COLLISION_RULE(CAT_SHIP,    CAT_SAUCER) // saucer rams ship
+
+/******************************************************************************
+ * CollisionPair: the rule for categories A and B in either order. When 
+ *    A > B the entities are swapped to match the rule
+ *****************************************************************************/
+template <int A, int B, bool SWAP = (A > B)>
+struct CollisionPair
+{
+   static const bool INTERACTS = CollisionRule<A, B>::INTERACTS;
+
+   static void resolve(Environment* pEnvironment, Moveable* m1, Moveable* m2)
+   {
+      CollisionRule<A, B>::resolve(pEnvironment, m1, m2);
+   }
+};
+
+template <int A, int B>
+struct CollisionPair<A, B, true>
+{
+   static const bool INTERACTS = CollisionRule<B, A>::INTERACTS;
+
+   static void resolve(Environment* pEnvironment, Moveable* m1, Moveable* m2)
+   {
+      CollisionRule<B, A>::resolve(pEnvironment, m2, m1);
+   }
+};
+
+/******************************************************************************
+ * CollisionMask: bit B of VALUE is set when category A interacts with 
+ *    category B (the bits below B are filled in recursively)
+ *****************************************************************************/
+template <int A, int B = CAT_COUNT - 1>
+struct CollisionMask
+{
+   static const unsigned VALUE = 
+      (CollisionPair<A, B>::INTERACTS ? 1u << B : 0u) |
+      CollisionMask<A, B - 1>::VALUE;
+};
+
+template <int A>
+struct CollisionMask<A, -1>
+{
+   static const unsigned VALUE = 0;
+};
+
+/******************************************************************************
+ * Indices: the pack 0 .. N-1, used to expand the tables below
+ *****************************************************************************/
+template <int... I>
+struct Indices { };
+
+template <int N, int... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+
+template <int... I>
+struct MakeIndices<0, I...> { typedef Indices<I...> Type; };
+
+/******************************************************************************
+ * CollisionMasks: the CollisionMask of every category
+ * CollisionHandlers: the resolve of every pair of categories, by 
+ *    a * CAT_COUNT + b
+ *****************************************************************************/
+template <class T>
+struct CollisionMasks;
+
+template <int... I>
+struct CollisionMasks<Indices<I...> >
+{
+   static constexpr unsigned VALUES[sizeof...(I)] = 
+      { CollisionMask<I>::VALUE... };
+};
+
+template <int... I>
+constexpr unsigned CollisionMasks<Indices<I...> >::VALUES[sizeof...(I)];
+
+template <class T>
+struct CollisionHandlers;
+
+template <int... I>
+struct CollisionHandlers<Indices<I...> >
+{
+   static constexpr CollisionHandler VALUES[sizeof...(I)] = 
+      { &CollisionPair<I / CAT_COUNT, I % CAT_COUNT>::resolve... };
+};
+
+template <int... I>
+constexpr CollisionHandler 
+   CollisionHandlers<Indices<I...> >::VALUES[sizeof...(I)];
+
+typedef CollisionMasks<MakeIndices<CAT_COUNT>::Type> CollisionMaskTable;
+typedef CollisionHandlers<MakeIndices<CAT_COUNT * CAT_COUNT>::Type> 
+   CollisionHandlerTable;
+
+/******************************************************************************
+ * collisionMask: the categories that category a interacts with, as bits
+ *****************************************************************************/
+inline constexpr unsigned collisionMask(Category a)
+{
+   return CollisionMaskTable::VALUES[a];
+}
+
+/******************************************************************************
+ * canCollide: whether entities of categories a and b ever interact
+ *****************************************************************************/
+inline constexpr bool canCollide(Category a, Category b)
+{
+   return (collisionMask(a) >> b) & 1u;
+}
+
+/******************************************************************************
+ * collisionHandler: the rule to apply when entities of categories a and b 
+ *    touch (a no-op when they don't interact)
+ *****************************************************************************/
+inline CollisionHandler collisionHandler(Category a, Category b)
+{
+   return CollisionHandlerTable::VALUES[a * CAT_COUNT + b];
+}
+
+/******************************************************************************
+ * Contact: two entities whose collision circles overlap, by slot (a < b)
+ *****************************************************************************/
+struct Contact
+{
+   int a;
+   int b;
+};
+
+inline bool operator < (const Contact &lhs, const Contact &rhs)
+{
+   return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
+}
+
+inline bool operator == (const Contact &lhs, const Contact &rhs)
+{
+   return lhs.a == rhs.a && lhs.b == rhs.b;
+}
+
+/******************************************************************************
+ * findContacts: narrowphase. Appends each candidate pair that can interact 
+ *    and whose collision circles overlap to the contact list. Only reads 
+ *    the store, so separate ranges of candidates can be tested 
+ *    independently of each other
+ *    INPUT : store     : entity positions and radii
+ *            candidates: broadphase pairs (see SpatialGrid::findPairs)
+ *            begin, end: range of candidates to test
+ *    OUTPUT: contacts  : the overlapping pairs, appended
+ *****************************************************************************/
+void findContacts(const EntityStore &store,
+                  const std::vector<std::pair<int, int> > &candidates,
+                  int begin, int end, std::vector<Contact> &contacts);
+
+/******************************************************************************
+ * sortContacts: puts the contacts in canonical order (by lower slot, then by
+ *    higher slot) and drops duplicates, so resolution does not depend on the
+ *    order, or the number of times, detection found each pair
+ *    INPUT/OUTPUT: contacts: the contact list
+ *****************************************************************************/
+void sortContacts(std::vector<Contact> &contacts);
+
+#endif
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * command.cpp: implements the CommandQueue class
+ *****************************************************************************/
+#include "command.h"
+using namespace std;
+
+/******************************************************************************
+ * push: records a command with the given type and default arguments
+ *    OUTPUT: <return>: the new command, to fill in the arguments
+ *****************************************************************************/
+Command &CommandQueue::push(CommandType type)
+{
+   Command command;
+   command.type   = type;
+   command.kind   = SPAWN_SMALL_ROCK;
+   command.angle  = 0;
+   command.value  = 0;
+   command.pSound = NULL;
+
+   mCommands.push_back(command);
+   return mCommands.back();
+}
+
+/******************************************************************************
+ * spawn: records the creation of an entity
+ *    INPUT: kind  : which entity to create
+ *           v     : its starting position and velocity
+ *           angle : direction it is fired in (bullets and missiles)
+ *****************************************************************************/
+void CommandQueue::spawn(SpawnKind kind, const Vector &v, float angle)
+{
+   Command &command = push(CMD_SPAWN);
+   command.kind   = kind;
+   command.vector = v;
+   command.angle  = angle;
+}
+
+/******************************************************************************
+ * addScore: records points being scored
+ *****************************************************************************/
+void CommandQueue::addScore(int points)
+{
+   push(CMD_SCORE).value = points;
+}
+
+/******************************************************************************
+ * addRocks: records asteroids being added to the wave's count
+ *****************************************************************************/
+void CommandQueue::addRocks(int count)
+{
+   push(CMD_ROCKS).value = count;
+}
+
+/******************************************************************************
+ * play: records a sound being started
+ *    INPUT: sound: filename of the sound. Only its address is kept, so it
+ *                  must outlive the queue (a constant, not a temporary)
+ *           loop : whether to loop the sound
+ *****************************************************************************/
+void CommandQueue::play(const string &sound, bool loop)
+{
+   Command &command = push(CMD_PLAY);
+   command.pSound = &sound;
+   command.value  = loop;
+}
+
+/******************************************************************************
+ * stop: records a sound being stopped
+ *    INPUT: sound: filename of the sound (same lifetime rules as play)
+ *****************************************************************************/
+void CommandQueue::stop(const string &sound)
+{
+   push(CMD_STOP).pSound = &sound;
+}
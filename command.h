@@ -0,0 +1,114 @@
+/******************************************************************************
+ * command.h: defines the CommandQueue class which records the side effects
+ *    of a simulation step (spawning, scoring and sounds) so they can be 
+ *    applied together once the step is over
+ *****************************************************************************/
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "vector.h"
+#include <string>
+#include <vector>
+
+/******************************************************************************
+ * CommandType: what a command does when it is applied
+ *****************************************************************************/
+enum CommandType
+{
+   CMD_SPAWN, // create a new entity           (kind, vector, angle)
+   CMD_SCORE, // add to the game score         (value)
+   CMD_ROCKS, // add to the number of asteroids (value)
+   CMD_PLAY,  // start a sound                 (pSound, value = loop)
+   CMD_STOP   // stop a sound                  (pSound)
+};
+
+/******************************************************************************
+ * SpawnKind: which entity a CMD_SPAWN command creates
+ *****************************************************************************/
+enum SpawnKind
+{
+   SPAWN_SMALL_ROCK,
+   SPAWN_MED_ROCK,
+   SPAWN_LARGE_ROCK,
+   SPAWN_BULLET,
+   SPAWN_MISSILE,
+   SPAWN_EXPLOSION_ORANGE,
+   SPAWN_EXPLOSION_BLUE
+};
+
+/******************************************************************************
+ * Command: a single recorded side effect
+ *****************************************************************************/
+struct Command
+{
+   CommandType        type;
+   SpawnKind          kind;
+   Vector             vector;
+   float              angle;
+   int                value;
+   const std::string* pSound;
+};
+
+/******************************************************************************
+ * CommandQueue: the side effects recorded during one simulation step. 
+ *    Entities are never created or destroyed while the step is running; the
+ *    environment applies the queue, in the order it was recorded, at the end
+ *    of the step
+ *****************************************************************************/
+class CommandQueue
+{
+private:
+
+   std::vector<Command> mCommands;
+
+   /***************************************************************************
+    * push: records a command with the given type and default arguments
+    *    OUTPUT: <return>: the new command, to fill in the arguments
+    **************************************************************************/
+   Command &push(CommandType type);
+
+public:
+
+   CommandQueue() { mCommands.reserve(256); }
+
+   /***************************************************************************
+    * spawn: records the creation of an entity
+    *    INPUT: kind  : which entity to create
+    *           v     : its starting position and velocity
+    *           angle : direction it is fired in (bullets and missiles)
+    **************************************************************************/
+   void spawn(SpawnKind kind, const Vector &v, float angle = 0);
+
+   /***************************************************************************
+    * addScore: records points being scored
+    **************************************************************************/
+   void addScore(int points);
+
+   /***************************************************************************
+    * addRocks: records asteroids being added to the wave's count
+    **************************************************************************/
+   void addRocks(int count);
+
+   /***************************************************************************
+    * play: records a sound being started
+    *    INPUT: sound: filename of the sound. Only its address is kept, so it
+    *                  must outlive the queue (a constant, not a temporary)
+    *           loop : whether to loop the sound
+    **************************************************************************/
+   void play(const std::string &sound, bool loop = false);
+
+   /***************************************************************************
+    * stop: records a sound being stopped
+    *    INPUT: sound: filename of the sound (same lifetime rules as play)
+    **************************************************************************/
+   void stop(const std::string &sound);
+
+   /***************************************************************************
+    * Access to the recorded commands
+    **************************************************************************/
+   int  size() const                         { return (int)mCommands.size(); }
+   const Command &operator[](int i) const    { return mCommands[i];          }
+   void clear()                              { mCommands.clear();            }
+};
+
+#endif
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * effect.cpp: implements the EffectTimeline
+ *****************************************************************************/
+#include "effect.h"
+#include "sprite.h"
+#include <assert.h>
+using namespace std;
+
+/******************************************************************************
+ * ease: the eased progress of a tween
+ *    INPUT : t   : linear progress, 0 to 1
+ *            ease: the curve
+ *****************************************************************************/
+float ease(float t, Ease ease)
+{
+   switch (ease)
+   {
+   case EASE_IN:
+      return t * t;
+   case EASE_OUT:
+      return t * (2 - t);
+   case EASE_IN_OUT:
+      return t * t * (3 - 2 * t);
+   default:
+      return t;
+   }
+}
+
+/******************************************************************************
+ * add: starts a tween
+ *****************************************************************************/
+void EffectTimeline::add(SpriteInstance* pSprite, TweenProperty property, 
+                         float from, float to, float duration, Ease ease, 
+                         float delay)
+{
+   assert(pSprite != NULL && duration > 0);
+   assert(property != TWEEN_BLINK || from > 0);
+
+   int tween;
+   if (!mFree.empty())
+   {
+      tween = mFree.back();
+      mFree.pop_back();
+   }
+   else
+   {
+      tween = mTarget.size();
+      mTarget.push_back(NULL);
+      mProperty.push_back(0);
+      mEase.push_back(0);
+      mFrom.push_back(0);
+      mTo.push_back(0);
+      mDelay.push_back(0);
+      mDuration.push_back(0);
+      mElapsed.push_back(0);
+      mNext.push_back(-1);
+   }
+
+   mTarget[tween]   = pSprite;
+   mProperty[tween] = property;
+   mEase[tween]     = ease;
+   mFrom[tween]     = from;
+   mTo[tween]       = to;
+   mDelay[tween]    = delay;
+   mDuration[tween] = duration;
+   mElapsed[tween]  = 0;
+
+   // Put it at the head of the sprite's chain
+   mNext[tween]     = pSprite->tweens;
+   pSprite->tweens  = tween;
+
+   mActive++;
+}
+
+/******************************************************************************
+ * release: unlinks a tween from its sprite and frees its slot
+ *****************************************************************************/
+void EffectTimeline::release(int tween)
+{
+   SpriteInstance* pSprite = mTarget[tween];
+
+   // A sprite has a handful of tweens at most
+   int* pLink = &pSprite->tweens;
+   while (*pLink != tween)
+   {
+      assert(*pLink != -1);
+      pLink = &mNext[*pLink];
+   }
+   *pLink = mNext[tween];
+
+   mTarget[tween] = NULL;
+   mFree.push_back(tween);
+   mActive--;
+}
+
+/******************************************************************************
+ * cancel: stops every tween of a sprite, leaving it as it is
+ *****************************************************************************/
+void EffectTimeline::cancel(SpriteInstance* pSprite)
+{
+   while (pSprite->tweens != -1)
+      release(pSprite->tweens);
+}
+
+/******************************************************************************
+ * advance: moves every tween on and applies it to its sprite
+ *    INPUT: dt: the amount of time that has passed, in seconds
+ *****************************************************************************/
+void EffectTimeline::advance(float dt)
+{
+   int count = mTarget.size();
+
+   for (int i = 0; i < count; i++)
+   {
+      SpriteInstance* pSprite = mTarget[i];
+      if (pSprite == NULL)
+         continue;
+
+      float elapsed = (mElapsed[i] += dt) - mDelay[i];
+      if (elapsed < 0)
+         continue;
+
+      bool  finished = elapsed >= mDuration[i];
+      float t        = finished ? 1 : elapsed / mDuration[i];
+      float value    = mFrom[i] + (mTo[i] - mFrom[i]) * 
+                       ease(t, (Ease)mEase[i]);
+
+      switch (mProperty[i])
+      {
+      case TWEEN_SIZE:
+         pSprite->width  = value;
+         pSprite->height = value;
+         break;
+      case TWEEN_WIDTH:
+         pSprite->width  = value;
+         break;
+      case TWEEN_HEIGHT:
+         pSprite->height = value;
+         break;
+      case TWEEN_ALPHA:
+         pSprite->alpha  = value;
+         break;
+      case TWEEN_ROTATION:
+         pSprite->spin   = value;
+         break;
+      case TWEEN_BLINK:
+         pSprite->visible = finished || (int)(elapsed / mFrom[i]) % 2 == 0;
+         break;
+      }
+
+      if (finished)
+         release(i);
+   }
+}
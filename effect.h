@@ -0,0 +1,110 @@
+/******************************************************************************
+ * effect.h: defines the EffectTimeline, which animates properties of 
+ *    entities' sprites (size, visibility, transparency, rotation) over time
+ *****************************************************************************/
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <vector>
+
+struct SpriteInstance;
+
+/******************************************************************************
+ * TweenProperty: what a tween changes
+ *    TWEEN_BLINK toggles the sprite's visibility every 'from' seconds and 
+ *    leaves it visible when it ends ('to' is not used)
+ *****************************************************************************/
+enum TweenProperty
+{
+   TWEEN_SIZE,     // width and height
+   TWEEN_WIDTH,
+   TWEEN_HEIGHT,
+   TWEEN_ALPHA,    // 0 transparent to 1 opaque
+   TWEEN_ROTATION, // degrees added to the entity's rotation
+   TWEEN_BLINK
+};
+
+/******************************************************************************
+ * Ease: how a tween moves from its start value to its end value
+ *****************************************************************************/
+enum Ease
+{
+   EASE_LINEAR,
+   EASE_IN,      // starts slowly (quadratic)
+   EASE_OUT,     // ends slowly (quadratic)
+   EASE_IN_OUT   // both (smoothstep)
+};
+
+/******************************************************************************
+ * EffectTimeline: every running tween, kept in flat arrays and advanced in 
+ *    one pass. A tween's slot goes back on a free list when it finishes or 
+ *    is cancelled, so once the timeline has held its peak number of tweens
+ *    adding more allocates nothing. The tweens of one sprite are chained 
+ *    from SpriteInstance::tweens, so they can be cancelled when the sprite
+ *    goes away
+ *****************************************************************************/
+class EffectTimeline
+{
+private:
+
+   std::vector<SpriteInstance*> mTarget;   // NULL when the slot is free
+   std::vector<unsigned char>   mProperty;
+   std::vector<unsigned char>   mEase;
+   std::vector<float>           mFrom;
+   std::vector<float>           mTo;
+   std::vector<float>           mDelay;    // seconds before it starts
+   std::vector<float>           mDuration;
+   std::vector<float>           mElapsed;
+   std::vector<int>             mNext;     // the sprite's next tween, or -1
+   std::vector<int>             mFree;
+   int                          mActive;
+
+   /***************************************************************************
+    * release: unlinks a tween from its sprite and frees its slot
+    **************************************************************************/
+   void release(int tween);
+
+public:
+
+   EffectTimeline() : mActive(0) { }
+
+   /***************************************************************************
+    * add: starts a tween
+    *    INPUT: pSprite : the sprite to animate (must outlive the tween or 
+    *                     cancel it)
+    *           property: what to change
+    *           from, to: start and end values
+    *           duration: seconds from start to end
+    *           ease    : the curve between them
+    *           delay   : seconds to wait before starting
+    **************************************************************************/
+   void add(SpriteInstance* pSprite, TweenProperty property, float from,
+            float to, float duration, Ease ease = EASE_LINEAR, 
+            float delay = 0);
+
+   /***************************************************************************
+    * cancel: stops every tween of a sprite, leaving it as it is
+    **************************************************************************/
+   void cancel(SpriteInstance* pSprite);
+
+   /***************************************************************************
+    * advance: moves every tween on and applies it to its sprite
+    *    INPUT: dt: the amount of time that has passed, in seconds
+    **************************************************************************/
+   void advance(float dt);
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   int getActive()   const { return mActive;         }
+   int getCapacity() const { return mTarget.size();  }
+};
+
+/******************************************************************************
+ * ease: the eased progress of a tween
+ *    INPUT : t   : linear progress, 0 to 1
+ *            ease: the curve
+ *****************************************************************************/
+float ease(float t, Ease ease);
+
+#endif
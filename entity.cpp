@@ -2,26 +2,118 @@
 #include <iostream>
 using namespace std;
 
+/******************************************************************************
+ * Pools for the entities that are spawned throughout a game
+ *****************************************************************************/
+Pool Bullet::sPool   ("Bullet",    sizeof(Missile),   64);
+Pool Rock::sPool     ("Rock",      sizeof(LargeRock), 128);
+Pool Explosion::sPool("Explosion", sizeof(Explosion), 16);
+
+/******************************************************************************
+ * Texture names, built once rather than on every spawn
+ *****************************************************************************/
+static const string BULLET_TEXTURE           = SPR("bullet");
+static const string ASTEROID_TEXTURE         = SPR("asteroid");
+static const string EXPLOSION_ORANGE_TEXTURE = SPR("explosion-orange");
+static const string EXPLOSION_BLUE_TEXTURE   = SPR("explosion-blue");
+
+/******************************************************************************
+ * Sound names. Recorded sound commands keep a pointer to the name, so these
+ *    must live for the whole game
+ *****************************************************************************/
+static const string FIRE_SOUND        = WAV("fire");
+static const string THRUST_SOUND      = WAV("thrust");
+static const string EXTRA_SHIP_SOUND  = WAV("extraShip");
+static const string SAUCER_SOUND      = WAV("saucerBig");
+static const string BANG_SMALL_SOUND  = WAV("bangSmall");
+static const string BANG_MEDIUM_SOUND = WAV("bangMedium");
+static const string BANG_LARGE_SOUND  = WAV("bangLarge");
+
+/******************************************************************************
+ * spawn: creates the entity described by a CMD_SPAWN command
+ *    INPUT : pEnvironment: the environment the entity will live in
+ *            command     : the recorded spawn
+ *    OUTPUT: <return>    : the new entity (owned by the entity store)
+ *****************************************************************************/
+Moveable* spawn(Environment* pEnvironment, const Command &command)
+{
+   assert(command.type == CMD_SPAWN);
+
+   switch (command.kind)
+   {
+   case SPAWN_SMALL_ROCK:
+      return new SmallRock(pEnvironment, command.vector);
+   case SPAWN_MED_ROCK:
+      return new MedRock(pEnvironment, command.vector);
+   case SPAWN_LARGE_ROCK:
+      return new LargeRock(pEnvironment, command.vector);
+   case SPAWN_BULLET:
+      return new Bullet(pEnvironment, command.vector, command.angle);
+   case SPAWN_MISSILE:
+      return new Missile(pEnvironment, command.vector, command.angle);
+   case SPAWN_EXPLOSION_ORANGE:
+      return new Explosion(pEnvironment, command.vector, 
+         EXPLOSION_ORANGE_TEXTURE);
+   case SPAWN_EXPLOSION_BLUE:
+      return new Explosion(pEnvironment, command.vector, 
+         EXPLOSION_BLUE_TEXTURE);
+   }
+
+   return NULL;
+}
+
 /******************************************************************************
  * Moveable
  *****************************************************************************/
 Moveable::Moveable(Environment* pEnvironment, Vector v)
-   : fDead(false), rotation(0), pEnvironment(pEnvironment), vector(v)
+   : pEnvironment(pEnvironment), pStore(pEnvironment->getEntities()), size(0),
+     spriteCount(0)
 {
+   mSlot = pStore->add(this, v);
 }
 
 Moveable::~Moveable()
 {
-   for (std::vector<Sprite*>::iterator it = sprites.begin();
-      it != sprites.end();
-      it++)
-   {
-      delete *it;
-   }
+   for (int i = 0; i < spriteCount; i++)
+      pEnvironment->getEffects()->cancel(&sprites[i]);
+
+   pStore->remove(mSlot);
+}
+
+bool Moveable::isDead() const
+{
+   return pStore->dead(mSlot) != 0;
+}
+
+void Moveable::kill()
+{
+   pStore->dead(mSlot) = true;
+}
+
+float Moveable::getRotation() const
+{
+   return pStore->rotation(mSlot);
+}
+
+Vector Moveable::getVector() const
+{
+   return pStore->getVector(mSlot);
+}
+
+int Moveable::getSize() const
+{
+   return (int)pStore->radius(mSlot);
+}
+
+Category Moveable::getCategory() const
+{
+   return pStore->category(mSlot);
 }
 
 void Moveable::setRotation(float rot)
 {
+   float &rotation = pStore->rotation(mSlot);
+
    rotation = rot;
    if (rotation >= 360)
       rotation -= 360; //reset to 0 degrees
@@ -29,32 +121,67 @@ void Moveable::setRotation(float rot)
       rotation += 360; //reset to 360 degrees
 }
 
-void Moveable::addSprite(string texture)
+void Moveable::setVector(const Vector &v)
 {
-   sprites.push_back(new AnimatedSprite(
-      pEnvironment->getGraphics(), texture, size * 2, size * 2));
+   pStore->setVector(mSlot, v);
 }
 
-void Moveable::draw(float dt)
+void Moveable::setVelocity(float dx, float dy)
 {
-   for (std::vector<Sprite*>::iterator it = sprites.begin();
-      it != sprites.end();
-      it++)
-   {
-      (*it)->draw(vector.getX(), vector.getY(), getRotation(), dt);
-   }
+   pStore->dx(mSlot) = dx;
+   pStore->dy(mSlot) = dy;
 }
 
-void Moveable::wrap()
+void Moveable::setPosition(float x, float y)
 {
-   if (vector.getX() > pEnvironment->getXMax()) //right
-      vector.setX(pEnvironment->getXMin());
-   if (vector.getX() < pEnvironment->getXMin()) //left
-      vector.setX(pEnvironment->getXMax());
-   if (vector.getY() > pEnvironment->getYMax()) //top
-      vector.setY(pEnvironment->getYMin());
-   if (vector.getY() < pEnvironment->getYMin()) //bottom
-      vector.setY(pEnvironment->getYMax());
+   pStore->x(mSlot) = x;
+   pStore->y(mSlot) = y;
+}
+
+void Moveable::setRadius(int radius)
+{
+   pStore->radius(mSlot) = (float)radius;
+}
+
+void Moveable::setCategory(Category category)
+{
+   pStore->setCategory(mSlot, category);
+}
+
+void Moveable::setSpin(float spin)
+{
+   pStore->spin(mSlot) = spin;
+}
+
+void Moveable::setLifetime(float seconds)
+{
+   pStore->lifetime(mSlot) = seconds;
+}
+
+void Moveable::addSprite(const string &texture)
+{
+   assert(spriteCount < MAX_SPRITES);
+
+   SpriteInstance &sprite = sprites[spriteCount++];
+   sprite.pDef    = pEnvironment->getGraphics()->loadSpriteDef(texture);
+   sprite.elapsed = 0;
+   sprite.width   = size * 2;
+   sprite.height  = size * 2;
+   sprite.alpha   = 1;
+   sprite.spin    = 0;
+   sprite.tweens  = -1;
+   sprite.visible = true;
+}
+
+void Moveable::draw(float dt)
+{
+   float x = pStore->x(mSlot);
+   float y = pStore->y(mSlot);
+
+   for (int i = 0; i < spriteCount; i++)
+   {
+      sprites[i].draw(pEnvironment->getGraphics(), x, y, getRotation(), dt);
+   }
 }
 
 /******************************************************************************
@@ -64,33 +191,21 @@ Bullet::Bullet(Environment* pEnvironment, Vector v, float angle)
    : Moveable(pEnvironment, v)
 {  
 	//play a 'fire bullet' sound
-	pEnvironment->getAudio()->play(WAV("fire"), 0);
+	pEnvironment->getAudio()->play(FIRE_SOUND, false, AUDIO_PRIORITY_LOW);
 
    size = 5;
-   addSprite(SPR("bullet"));
+   addSprite(BULLET_TEXTURE);
+   setCategory(CAT_BULLET);
+   setRadius(1);
 
    //add in the direction ship is facing
    // (use minus sign because object rotation is reversed)
-   vector.setDX((float)(v.getDX()
-		- calcDX((float)(angle + 275), 300)));
-   vector.setDY((float)(v.getDY()
-		- calcDY((float)(angle + 275), 300)));
-   
-   //copy position of ship
-   vector.setX(v.getX());
-   vector.setY(v.getY());
-
-   timeLeft = .85;
-}
-
-void Bullet::operator += (float dt) //advance
-{ 
-   vector.advance(dt);
-   wrap(); 
-   timeLeft -= dt;
+   // (the position of the ship was copied when the slot was claimed)
+   float dx, dy;
+   calcDXDY((float)(angle + 275), 300, dx, dy);
+   setVelocity(v.getDX() - dx, v.getDY() - dy);
 
-   if (timeLeft <= 0)
-      kill();
+   setLifetime(.85);
 }
 
 /******************************************************************************
@@ -103,20 +218,11 @@ Missile::Missile(Environment* pEnvironment, Vector v, float angle)
 	//pEnvironment->getAudio()->play(WAV("fire"), 0);
 
    size = 5;
-   addSprite(SPR("bullet"));
+   addSprite(BULLET_TEXTURE);
+   setCategory(CAT_MISSILE);
 
-   //add in the direction of angle
-   // (use minus sign because object rotation is reversed)
-   vector.setDX((float)(v.getDX()
-		- calcDX((float)(angle + 275), 300)));
-   vector.setDY((float)(v.getDY()
-		- calcDY((float)(angle + 275), 300)));
-   
-   //copy position of ship
-   vector.setX(v.getX());
-   vector.setY(v.getY());
-
-   timeLeft = .8;
+   //same direction and speed as a Bullet, but a shorter range
+   setLifetime(.8);
 }
 
 /******************************************************************************
@@ -124,17 +230,12 @@ Missile::Missile(Environment* pEnvironment, Vector v, float angle)
  *****************************************************************************/
 Rock::Rock(Environment* pEnvironment, Vector v) : Shootable(pEnvironment, v)
 {
-	rotation = (float)((rand() % 36) * 10); //random starting rotation
-	dRotation = (float)(rand() % 2); //one or zero
+	Random* pRandom = pEnvironment->getRandom();
+	setRotation((float)(pRandom->nextInt(0, 35) * 10)); //random starting rotation
+	dRotation = (float)pRandom->nextInt(0, 1); //one or zero
 	if (dRotation == 0)
 		dRotation = -1;
-}
-
-void Rock::operator+=(float dt)
-{
-   vector.advance(dt);
-   rotation += dRotation * dt; 
-   wrap();
+   setCategory(CAT_ROCK);
 }
 
 /******************************************************************************
@@ -144,17 +245,19 @@ SmallRock::SmallRock(Environment* pEnvironment, Vector v)
    : Rock(pEnvironment, v)
 {
    size = 15;
-   addSprite(SPR("asteroid"));
+   setRadius(size);
+   addSprite(ASTEROID_TEXTURE);
    dRotation *= 200; // + or - 1 times 300
+   setSpin(dRotation);
 }
 
-SmallRock::~SmallRock()
+void SmallRock::destroyed()
 {
 	//play an 'explosion' sound
-	pEnvironment->getAudio()->play(WAV("bangSmall"), 0);
+	pEnvironment->getCommands()->play(BANG_SMALL_SOUND);
 
 	//add point to the game score
-	pEnvironment->addPoint();
+	pEnvironment->getCommands()->addScore(1);
 }
 
 /******************************************************************************
@@ -164,20 +267,24 @@ MedRock::MedRock(Environment* pEnvironment, Vector v)
    : Rock(pEnvironment, v)
 {
    size = 20;
-   addSprite(SPR("asteroid"));
+   setRadius(size);
+   addSprite(ASTEROID_TEXTURE);
    dRotation *= 75; // + or - 1 times 150
+   setSpin(dRotation);
 }
 
-MedRock::~MedRock()
+void MedRock::destroyed()
 {
+   CommandQueue* pCommands = pEnvironment->getCommands();
+
 	//play an 'explosion' sound
-	pEnvironment->getAudio()->play(WAV("bangMedium"), 0);
+	pCommands->play(BANG_MEDIUM_SOUND);
 
 	//add point to the game score
-	pEnvironment->addPoint();
+	pCommands->addScore(1);
 
 	//add 2 to mAsteroidCount
-	pEnvironment->addRockNum(2);
+	pCommands->addRocks(2);
 
 	//make a temporary copy of destroyed rock's vector
 	Vector oldVector(this->getVector());
@@ -185,11 +292,11 @@ MedRock::~MedRock()
 	//add new asteroids where medium one died
 	Vector temp(0, 0, 30, 0); //x, y, dx, dy --> dx goes right by 3
 	oldVector += temp;
-	pEnvironment->add(new SmallRock(pEnvironment, oldVector)); //small rock
+	pCommands->spawn(SPAWN_SMALL_ROCK, oldVector); //small rock
 
 	temp.setDX(-60); //reset dx and move dx left by 3
 	oldVector += temp;
-   	pEnvironment->add(new SmallRock(pEnvironment, oldVector)); //small rock
+	pCommands->spawn(SPAWN_SMALL_ROCK, oldVector); //small rock
 }
 
 /******************************************************************************
@@ -199,22 +306,26 @@ LargeRock::LargeRock(Environment* pEnvironment, Vector v)
    : Rock(pEnvironment, v)
 {
    size = 25;
-   addSprite(SPR("asteroid"));
+   setRadius(size);
+   addSprite(ASTEROID_TEXTURE);
 
    dRotation *= 50; // + or - 1 times 100
+   setSpin(dRotation);
 }
 
-//Large Rock destructor: creates 3 new asteroids of smaller sizes
-LargeRock::~LargeRock()
+//Large Rock destroyed: creates 3 new asteroids of smaller sizes
+void LargeRock::destroyed()
 {
+   CommandQueue* pCommands = pEnvironment->getCommands();
+
 	//play an 'explosion' sound
-	pEnvironment->getAudio()->play(WAV("bangLarge"), 0);
+	pCommands->play(BANG_LARGE_SOUND);
 
 	//add point to the game score
-	pEnvironment->addPoint();
+	pCommands->addScore(1);
 
 	//add 3 to mAsteroidCount
-	pEnvironment->addRockNum(3);
+	pCommands->addRocks(3);
 
 	//make a temporary copy of destroyed rock's vector
 	Vector oldVector(this->getVector());
@@ -222,16 +333,16 @@ LargeRock::~LargeRock()
 	//add new asteroids where large one died
 	Vector temp(0, 0, 0, 10); //x, y, dx, dy --> dy goes up 1
 	oldVector += temp;
-	pEnvironment->add(new MedRock(pEnvironment, oldVector)); //medium rock
+	pCommands->spawn(SPAWN_MED_ROCK, oldVector); //medium rock
 	
 	temp.setDY(-20); // dy goes down 1
 	oldVector += temp;
-	pEnvironment->add(new MedRock(pEnvironment, oldVector)); //medium rock
+	pCommands->spawn(SPAWN_MED_ROCK, oldVector); //medium rock
 
 	temp.setDY(10); //reset dy to 0
 	temp.setDX(20); //dx goes right by 2
 	oldVector += temp;
-	pEnvironment->add(new SmallRock(pEnvironment, oldVector)); //small rock
+	pCommands->spawn(SPAWN_SMALL_ROCK, oldVector); //small rock
 }
 
 /******************************************************************************
@@ -242,46 +353,47 @@ Ship::Ship(Environment* pEnvironment, Vector v)
 {
    hasThrust = false;
    size = 16;
+   setCategory(CAT_SHIP);
+   setRadius(1);
    addSprite(SPR("ship-norm"));
    addSprite(SPR("ship-thrust"));
-   sprites[1]->setVisible(false);
+   sprites[1].visible = false;
 }
 
-Ship::~Ship()
+void Ship::destroyed()
 {
    // Make sure audio is cleared out
    setHasThrust(false);
-   pEnvironment->add(new Explosion(pEnvironment, vector, SPR("explosion-orange")));
+   pEnvironment->getCommands()->spawn(SPAWN_EXPLOSION_ORANGE, getVector());
 }
 
 void Ship::setHasThrust(bool isThrusting)
 {
    if (hasThrust && !isThrusting)
    {
-      sprites[0]->setVisible(true);
-      sprites[1]->setVisible(false);
-      pEnvironment->getAudio()->stop(WAV("thrust"));
+      sprites[0].visible = true;
+      sprites[1].visible = false;
+      pEnvironment->getCommands()->stop(THRUST_SOUND);
    }
    else if (!hasThrust && isThrusting)
    {
-      sprites[0]->setVisible(false);
-      sprites[1]->setVisible(true);
-      pEnvironment->getAudio()->play(WAV("thrust"), true);
+      sprites[0].visible = false;
+      sprites[1].visible = true;
+      pEnvironment->getCommands()->play(THRUST_SOUND, true);
    }
    hasThrust = isThrusting;
 }
 
 void Ship::operator +=(float dt) //advance
 {
-   vector.advance(dt);
    cooldown -= dt;
-   wrap();
 
    // Check keyboard
    if (pEnvironment->isSpace() && cooldown < 0)
    {
       cooldown = 0.5;
-      pEnvironment->add(new Bullet(pEnvironment, vector, getRotation()));
+      pEnvironment->getCommands()->spawn(
+         SPAWN_BULLET, getVector(), getRotation());
    }
    
    // Check for movement
@@ -298,28 +410,28 @@ void Ship::operator +=(float dt) //advance
    }  
    if (pEnvironment->isUp())
    {
-      vector.setDX((float)(getVector().getDX()
-			- calcDX((float)(getRotation() + 275), 50 * dt)));
-      vector.setDY((float)(getVector().getDY()
-			- calcDY((float)(getRotation() + 275), 50 * dt)));
+      Vector v = getVector();
+      float dx, dy;
+      calcDXDY((float)(getRotation() + 275), 50 * dt, dx, dy);
+      setVelocity(v.getDX() - dx, v.getDY() - dy);
    }
    if (pEnvironment->isDown())
    {
-      vector.setDX((float)(getVector().getDX() / (1 + dt * 1.1)));
-      vector.setDY((float)(getVector().getDY() / (1 + dt * 1.1)));
+      Vector v = getVector();
+      setVelocity((float)(v.getDX() / (1 + dt * 1.1)),
+                  (float)(v.getDY() / (1 + dt * 1.1)));
    }
-   if (pEnvironment->isKey('h') && cooldown <= 0)
+   if (pEnvironment->isHyperspace() && cooldown <= 0)
    {
-      float x = Graphics::random(
+      float x = pEnvironment->getRandom()->nextFloat(
          pEnvironment->getXMin(), pEnvironment->getXMax());
-      float y = Graphics::random(
+      float y = pEnvironment->getRandom()->nextFloat(
          pEnvironment->getYMin(), pEnvironment->getYMax());
 
-      pEnvironment->add(new Explosion(pEnvironment, vector, SPR("explosion-blue")));
-      pEnvironment->getAudio()->play(WAV("extraShip"));
+      pEnvironment->getCommands()->spawn(SPAWN_EXPLOSION_BLUE, getVector());
+      pEnvironment->getCommands()->play(EXTRA_SHIP_SOUND);
 
-      vector.setX(x);
-      vector.setY(y);
+      setPosition(x, y);
 
       cooldown = 1;
    }
@@ -332,61 +444,50 @@ Saucer::Saucer(Environment* pEnvironment, Vector v)
    : Ship(pEnvironment, v)
 {
    size = 16;
+   setCategory(CAT_SAUCER);
+   setRadius(10);
    addSprite(SPR("saucer"));
 
 	//start sound loop
-	pEnvironment->getAudio()->play(WAV("saucerBig"), true);
+	pEnvironment->getAudio()->play(SAUCER_SOUND, true);
 }
 
-Saucer::~Saucer()
+void Saucer::destroyed()
 {
 	//end sound loop
-	pEnvironment->getAudio()->stop(WAV("saucerBig"));
+	pEnvironment->getCommands()->stop(SAUCER_SOUND);
+
+   Ship::destroyed();
 }
 
 void Saucer::operator +=(float dt) //advance
 {
-   vector.advance(dt);
    cooldown -= dt;
-   wrap();
 
    // fire random missiles
    if (cooldown < 0)
    {
-		float angle = (rand() % 10) * 36;
+		float angle = pEnvironment->getRandom()->nextInt(0, 9) * 36;
       cooldown = 0.8;
-      pEnvironment->add(new Missile(pEnvironment, vector, angle));
+      pEnvironment->getCommands()->spawn(SPAWN_MISSILE, getVector(), angle);
    }
 }
 
 /******************************************************************************
  * Explosion:
  *****************************************************************************/
-Explosion::Explosion(Environment* pEnvironment, Vector v, string texture)
+Explosion::Explosion(Environment* pEnvironment, Vector v, 
+      const string &texture)
    : Moveable(pEnvironment, v)
 {
    size = 16;
    addSprite(texture);
-   mElapsed = 0;
+   setVelocity(0, 0); // stays where it was created
+
+   // Grow from 32 to 200 for a quarter second, hold for a quarter, then
+   // shrink back for a quarter
+   EffectTimeline* pEffects = pEnvironment->getEffects();
+   pEffects->add(&sprites[0], TWEEN_SIZE, 32, 200, .25);
+   pEffects->add(&sprites[0], TWEEN_SIZE, 200, 32, .25, EASE_LINEAR, .5);
+   setLifetime(.75);
 }
-
-void Explosion::operator+=(float dt)
-{
-   if (mElapsed == 0)
-   {
-      sprites[0]->changeSize(200, 200, .25);
-   }
-   else if (!sprites[0]->hasEffects())
-   {
-      if (mElapsed > .5 && mElapsed < .75)
-      {
-         sprites[0]->changeSize(32, 32, .25);
-      }
-      else if (mElapsed > .75)
-      {
-         kill();
-      }
-   }
-
-   mElapsed += dt;
-}
\ No newline at end of file
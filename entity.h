@@ -2,18 +2,41 @@
 #define ASTEROIDS_H
 
 #include "environment.h"
+#include "store.h"
 #include "vector.h"
 #include "point.h"
 #include "sprite.h"
 #include "graphics.h"
+#include "pool.h"
+#include "command.h"
 #include <vector>
 #include <iostream>
 using namespace std;
 
 class Environment;
+class EntityStore;
 
 /******************************************************************************
- * Moveable: basic type of moveable pieces
+ * Most sprites any one entity uses (the saucer draws three)
+ *****************************************************************************/
+#define MAX_SPRITES 3
+
+/******************************************************************************
+ * POOLED: gives a class its own slab allocator (see pool.h). Spawning an 
+ *    entity then reuses the memory of one that died instead of going to the 
+ *    heap. Derived classes share the pool, so it is sized for the largest
+ *****************************************************************************/
+#define POOLED                                                                \
+   public:                                                                    \
+      static void* operator new(size_t size) { return sPool.allocate(size); } \
+      static void  operator delete(void* p)  { sPool.release(p);            } \
+      static Pool  sPool;
+
+/******************************************************************************
+ * Moveable: basic type of moveable pieces. The position, velocity, rotation,
+ *    collision radius, category and lifetime of every Moveable live in the
+ *    environment's EntityStore; a Moveable claims its slot when constructed 
+ *    and releases it when destroyed, so the store owns every live entity
  *****************************************************************************/
 class Moveable
 {
@@ -22,35 +45,60 @@ public:
    Moveable(Environment* pEnvironment, Vector v);
    virtual ~Moveable(); 
 
-   bool isDead() { return fDead; }
+   bool isDead() const;
    void setRotation(float rot);
       
-   float  getRotation() const { return rotation; }
-   Vector getVector() const { return vector;   }
+   float  getRotation() const;
+   Vector getVector()   const;
+   int    getSize()     const; // collision radius
+   Category getCategory() const;
+   int    getSlot()     const { return mSlot; }
 
-   virtual void kill() { fDead = true; }
+   virtual void kill();
    virtual void draw(float dt);
-   virtual int  getSize()  const { return size; }
-   virtual char getType()  const { return  ' '; }
 
-   virtual void operator+= (float dt) { vector.advance(dt); wrap(); };//advance
-
-   void wrap();
+   /***************************************************************************
+    * operator+=: runs any behavior beyond moving, which the store has 
+    *    already done for every entity this step
+    *    INPUT: dt: the amount of time that has passed, in seconds
+    **************************************************************************/
+   virtual void operator+= (float dt) { }
+
+   /***************************************************************************
+    * destroyed: called once the entity has died, at the end of the step and
+    *    just before it is deleted. Death side effects (explosions, points,
+    *    sounds, asteroids breaking apart) are recorded here as commands; 
+    *    destructors have no side effects
+    **************************************************************************/
+   virtual void destroyed() { }
 
 protected:
 
-   Vector       vector;
-   float        rotation;
    Environment* pEnvironment;
-   int          size;
+   EntityStore* pStore;
+   int          size; // sprite size
+
+   SpriteInstance sprites[MAX_SPRITES];
+   int            spriteCount;
 
-   std::vector<Sprite*> sprites;
+   void addSprite(const std::string &texture);
 
-   void addSprite(std::string texture);
+   /***************************************************************************
+    * Setters for the state kept in the store
+    **************************************************************************/
+   void setVector(const Vector &v);
+   void setVelocity(float dx, float dy);
+   void setPosition(float x, float y);
+   void setRadius(int radius);
+   void setCategory(Category category);
+   void setSpin(float spin);
+   void setLifetime(float seconds);
 
 private:
 
-   bool         fDead;
+   friend class EntityStore; // updates mSlot when the entity is moved
+
+   int mSlot;
 };
 
 /******************************************************************************
@@ -58,19 +106,12 @@ private:
  *****************************************************************************/
 class Bullet : public Moveable
 {
+   POOLED // shared with Missile
+
 public:
 
    //takes in vector of ship
    Bullet(Environment* pEnvironment, Vector v, float angle); 
-
-   virtual char getType() const { return 'b'; }
-   virtual int  getSize() const { return   1; }
-   virtual void operator += (float dt); //advance
-
-protected:
-
-   float timeLeft;
-
 };
 
 /******************************************************************************
@@ -81,8 +122,6 @@ class Missile : public Bullet
 public:
    //takes in vector of enemy ship
    Missile(Environment* pEnvironment, Vector v, float angle); 
-
-   virtual char getType() const { return 'm'; }
 };
 
 /******************************************************************************
@@ -90,16 +129,11 @@ public:
  *****************************************************************************/
 class Explosion : public Moveable
 {
-protected:
-
-   float mElapsed;
+   POOLED
 
 public:
 
-   Explosion(Environment* pEnvironment, Vector v, std::string texture);
-
-   virtual char getType() const { return ' '; }
-   virtual void operator += (float dt);
+   Explosion(Environment* pEnvironment, Vector v, const std::string &texture);
 };
 
 /******************************************************************************
@@ -123,11 +157,10 @@ class Ship : public Shootable
 {
 public:
    Ship(Environment* pEnvironment, Vector v);
-   ~Ship();
+
+   virtual void destroyed();
 
    virtual void operator += (float dt); //advance
-   virtual char getType() const { return 's'; }
-   virtual int  getSize() const {   return 1; }
 
 protected:
    float cooldown;
@@ -144,11 +177,10 @@ class Saucer : public Ship
 {
 public:
 	Saucer(Environment* pEnvironment, Vector v);
-	~Saucer();
+
+	virtual void destroyed();
 	
 	virtual void operator += (float dt); //advance
-	virtual char getType() const { return 'e'; }
-	virtual int  getSize() const { return  10; }
 };
 
 /******************************************************************************
@@ -156,16 +188,14 @@ public:
  *****************************************************************************/
 class Rock : public Shootable
 {
+   POOLED // shared with SmallRock, MedRock and LargeRock
+
 public:
 
    Rock(Environment* pEnvironment, Vector v);
 
-   virtual char getType() const { return 'r'; }
-
-   virtual void operator+=(float dt);
-
 protected:
-	float dRotation; //rotation speed
+	float dRotation; //rotation direction (spin is kept in the store)
 };
 
 /******************************************************************************
@@ -176,7 +206,8 @@ class LargeRock : public Rock
 public:
 
    LargeRock(Environment* pEnvironment, Vector v);
-   ~LargeRock();
+
+   virtual void destroyed();
 
 private:
 
@@ -190,7 +221,8 @@ class MedRock : public Rock
 public:
 
    MedRock(Environment* pEnvironment, Vector v);
-   ~MedRock();
+
+   virtual void destroyed();
 
 private:
 
@@ -204,10 +236,19 @@ class SmallRock : public Rock
 public:
 
    SmallRock(Environment* pEnvironment, Vector v);
-   ~SmallRock();
+
+   virtual void destroyed();
 
 private:
 
 };
 
+/******************************************************************************
+ * spawn: creates the entity described by a CMD_SPAWN command
+ *    INPUT : pEnvironment: the environment the entity will live in
+ *            command     : the recorded spawn
+ *    OUTPUT: <return>    : the new entity (owned by the entity store)
+ *****************************************************************************/
+Moveable* spawn(Environment* pEnvironment, const Command &command);
+
 #endif
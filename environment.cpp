@@ -4,29 +4,156 @@
 #include "environment.h"
 #include <math.h>
 #include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
 using namespace std;
 
-Environment::Environment(int argc, char* argv[])
-   : mGraphics(400, 400, "Asteroids!"), mAsteroidCount(0), mGameScore(0),
-	mWaveNumber(0)
+/******************************************************************************
+ * getOption: finds a --name=value option on the command line
+ *    INPUT : argc, argv: command line arguments
+ *            name      : the option, without the '='
+ *    OUTPUT: <return>  : its value, or NULL when it isn't given
+ *****************************************************************************/
+static const char* getOption(int argc, char* argv[], const char* name)
+{
+   size_t length = strlen(name);
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strncmp(argv[i], name, length) == 0 && argv[i][length] == '=')
+         return argv[i] + length + 1;
+   }
+   return NULL;
+}
+
+/******************************************************************************
+ * getWorkerOption: reads --workers=N from the command line
+ *    OUTPUT: <return>: N, or 0 (one worker per core) when it isn't given
+ *****************************************************************************/
+static int getWorkerOption(int argc, char* argv[])
+{
+   const char* workers = getOption(argc, argv, "--workers");
+   return workers ? atoi(workers) : 0;
+}
+
+/******************************************************************************
+ * getLatencyOption: reads --audio-latency=MS from the command line
+ *    OUTPUT: <return>: MS, or AUDIO_DEFAULT_LATENCY when it isn't given
+ *****************************************************************************/
+static int getLatencyOption(int argc, char* argv[])
+{
+   const char* latency = getOption(argc, argv, "--audio-latency");
+   return latency ? atoi(latency) : AUDIO_DEFAULT_LATENCY;
+}
+
+/******************************************************************************
+ * getAdaptiveOption: reads --audio-adaptive=0|1 from the command line
+ *    OUTPUT: <return>: whether the audio buffer may grow (it may unless
+ *                      told otherwise)
+ *****************************************************************************/
+static bool getAdaptiveOption(int argc, char* argv[])
+{
+   const char* adaptive = getOption(argc, argv, "--audio-adaptive");
+   return adaptive ? atoi(adaptive) != 0 : true;
+}
+
+/******************************************************************************
+ * printProfileLegend: explains the profile overlay's rows and columns on the
+ *    console, since the overlay itself can only draw digits
+ *****************************************************************************/
+static void printProfileLegend()
+{
+   cout << "profile overlay (microseconds):\n";
+   for (int p = 0; p < PHASE_COUNT; p++)
+   {
+      cout << "   " << p << " " << Profiler::getPhaseName((ProfilePhase)p)
+           << ": min, avg, max\n";
+   }
+   cout << "   " << PHASE_COUNT << " audio callback: deadline, avg, max, "
+        << "underruns (a count)\n";
+}
+
+/******************************************************************************
+ * Environment:
+ *    INPUT: argc, argv: command line arguments (--workers=N, --seed=N,
+ *                       --record=F, --replay=F, --profile=F, 
+ *                       --audio-latency=MS, --audio-adaptive=0|1)
+ *           headless  : run without a window, OpenGL context or audio
+ *                       device (see simulate)
+ *****************************************************************************/
+Environment::Environment(int argc, char* argv[], bool headless)
+   : mGraphics(400, 400, "Asteroids!", headless), 
+     mAudioManager(!headless, getLatencyOption(argc, argv),
+                   getAdaptiveOption(argc, argv)),
+     mJobs(getWorkerOption(argc, argv)),
+     mAsteroidCount(0), mGameScore(0), mWaveNumber(0), mPairTests(0),
+     mBruteForceTests(0)
 {
    memset(mKeyStates, false, sizeof(mKeyStates));
+   mPresses = 0;
+   mInput   = 0;
+
+   // A replay brings its own seed; everything random follows from it
+   const char* replayFile = getOption(argc, argv, "--replay");
+   const char* recordFile = getOption(argc, argv, "--record");
+
+   mReplaying = (replayFile != NULL);
+   if (mReplaying)
+   {
+      mReplay.load(replayFile);
+   }
+   else
+   {
+      const char* seed = getOption(argc, argv, "--seed");
+      mReplay = Replay(seed ? (unsigned)strtoul(seed, NULL, 10) : 
+                              (unsigned)(time(NULL) / 2));
+   }
+
+   if (recordFile != NULL)
+      mRecordFile = recordFile;
 
-   mMenuCountdown  = 3.0;
+   const char* profileFile = getOption(argc, argv, "--profile");
+   if (profileFile != NULL)
+      Profiler::openCsv(profileFile);
+   mShowProfile        = false;
+   mProfileLegendShown = false;
+
+   mRandom.setSeed(mReplay.getSeed());
+
+   // Nobody is there to read the menu in headless mode (but a replay was
+   // recorded with it showing)
+   mMenuCountdown  = (headless && !mReplaying) ? 0.0 : 3.0;
    mShipCountdown  = 3.0;
    mLivesRemaining = 3;
    mPaused         = false;
    mGameOver       = false;
 	mSaucerAttack	 = false;
 
+   // Everything drawn during play shares one texture. The full-screen 
+   // images are only drawn one at a time, and the stars tile
+   const char* ATLAS_IMAGES[] = 
+   {
+      "asteroid", "bullet", "explosion-blue", "explosion-orange", "saucer",
+      "ship-norm", "ship-thrust", "top-menu"
+   };
+   vector<string> atlas;
+   for (int i = 0; i < sizeof(ATLAS_IMAGES) / sizeof(ATLAS_IMAGES[0]); i++)
+      atlas.push_back(SPR(ATLAS_IMAGES[i]));
+   mGraphics.buildAtlas(atlas);
+
    mpBackground = new TilingSprite(&mGraphics, SPR("stars"),     400, 400);
    mpMenu       = new       Sprite(&mGraphics, SPR("menu"),      320, 240);
    mpGameOver   = new       Sprite(&mGraphics, SPR("game-over"), 320, 240);
    mpTopMenu    = new       Sprite(&mGraphics, SPR("top-menu"),   400, 24);
 
+   // Room for a busy screen, so spawning doesn't have to grow the arrays
+   mEntities.reserve(1024);
+
    addShip(false);
 
-   mAudioManager.play(WAV("rachmaninov"), true);
+   mAudioManager.stream(WAV("rachmaninov"), true, AUDIO_PRIORITY_HIGH);
 }
 
 Environment::~Environment()
@@ -36,11 +163,22 @@ Environment::~Environment()
    delete mpGameOver;
    delete mpTopMenu; 
 
-   for (list<Moveable*>::iterator it = mEntities.begin();
-      it != mEntities.end();
-      it++)
+   if (!mRecordFile.empty())
    {
-      delete *it;
+      try
+      {
+         mReplay.save(mRecordFile);
+      }
+      catch (string ex)
+      {
+         cerr << ex << endl;
+      }
+   }
+
+   // Each entity releases its own slot when deleted
+   while (mEntities.size() > 0)
+   {
+      delete mEntities.getOwner(mEntities.size() - 1);
    }
 }
 
@@ -57,7 +195,6 @@ void Environment::addShip(bool subtractLife)
    if (mLivesRemaining >= 0)
    {
       mpShip = new Ship(this, Vector(getXMax() / 2, getYMax() / 2, 0, 0));
-      add(mpShip);
       mShipCountdown = 3.0;
    }
    else
@@ -84,27 +221,29 @@ void Environment::nextWave()
    {
       // Set the position away from where the ship is
       Vector v;
+      float  u[4];
 
       do 
       {
-         v.setX( Graphics::random(getXMin(), getXMax()));
-         v.setY( Graphics::random(getYMin(), getYMax()));
-         v.setDX(Graphics::random(-10 - delta, 10 + delta) * (1 + delta));
-         v.setDY(Graphics::random(-10 - delta, 10 + delta) * (1 + delta));
+         mRandom.fill(u, 4);
+         v.setX( getXMin() + u[0] * (getXMax() - getXMin()));
+         v.setY( getYMin() + u[1] * (getYMax() - getYMin()));
+         v.setDX((u[2] * 2 - 1) * (10 + delta) * (1 + delta));
+         v.setDY((u[3] * 2 - 1) * (10 + delta) * (1 + delta));
       }
       while ((center - v) < (100 - delta));
 
       // Generate some new asteroids
-      switch (Graphics::random(1, 3))
+      switch (mRandom.nextInt(1, 3))
       {
       case 1:
-         add(new SmallRock(this, v));
+         new SmallRock(this, v);
          break;
       case 2:
-         add(new   MedRock(this, v));
+         new   MedRock(this, v);
          break;
       case 3:
-         add(new LargeRock(this, v));
+         new LargeRock(this, v);
          break;
       }
    }
@@ -125,7 +264,7 @@ void Environment::saucerAttack()
 	Vector v(getXMax(), (getYMax() - getYMin()) / 2, -20, 0);
 
 	//create the enemy ship
-	add(new Saucer(this, v));
+	new Saucer(this, v);
 
 
 }
@@ -138,6 +277,51 @@ void Environment::start()
    mGraphics.run(this);
 }
 
+/******************************************************************************
+ * simulate: runs the game logic for the given number of steps as fast as
+ *    the CPU allows (intended for headless environments)
+ *    INPUT : steps   : number of SIM_STEP updates to run
+ *    OUTPUT: <return>: wall-clock seconds taken
+ *****************************************************************************/
+double Environment::simulate(int steps)
+{
+   return mGraphics.simulate(this, steps);
+}
+
+/******************************************************************************
+ * readInput: sets the input for the tick that is starting, either from the
+ *    keyboard (recording it when asked to) or from the replay
+ *****************************************************************************/
+void Environment::readInput()
+{
+   if (mReplaying)
+   {
+      mInput = mReplay.next();
+   }
+   else
+   {
+      mInput = mPresses;
+
+      if (mKeyStates[SDL_SCANCODE_SPACE])
+         mInput |= INPUT_SPACE;
+      if (mKeyStates[SDL_SCANCODE_LEFT])
+         mInput |= INPUT_LEFT;
+      if (mKeyStates[SDL_SCANCODE_RIGHT])
+         mInput |= INPUT_RIGHT;
+      if (mKeyStates[SDL_SCANCODE_UP])
+         mInput |= INPUT_UP;
+      if (mKeyStates[SDL_SCANCODE_DOWN])
+         mInput |= INPUT_DOWN;
+      if (mKeyStates[SDL_GetScancodeFromKey('h')])
+         mInput |= INPUT_HYPERSPACE;
+
+      if (!mRecordFile.empty())
+         mReplay.record(mInput);
+   }
+
+   mPresses = 0;
+}
+
 /******************************************************************************
  * keyUp: triggered when a key is released
  *    INPUT: key: the ascii character value
@@ -159,33 +343,48 @@ void Environment::keyDown(SDL_Keycode key)
    if (sc < SDL_NUM_SCANCODES)
       mKeyStates[sc] = true;
 
+   // Toggles take effect at the start of the next tick (see readInput)
    switch (key)
    {
    case 'm':
-      mMenuCountdown = (mMenuCountdown > 0) ? 0 : 5;
+      mPresses |= INPUT_MENU;
       break;
    case 'p':
-      mPaused = !mPaused;
+      mPresses |= INPUT_PAUSE;
       break;
-   }
-}
+   case 'o':
+      // Only changes what is drawn, so it isn't part of the replay. Timing
+      // stays on only while something reads it
+      mShowProfile = !mShowProfile;
+      Profiler::setEnabled(mShowProfile || Profiler::hasCsv());
 
-/***************************************************************************
- * add: adds a new entity to the environment
- *    INPUT: pEntity: pointer to the entity
- **************************************************************************/
-void Environment::add(Moveable* pEntity)
-{
-   mEntities.push_back(pEntity);
+      if (mShowProfile && !mProfileLegendShown)
+      {
+         printProfileLegend();
+         mProfileLegendShown = true;
+      }
+      break;
+   }
 }
 
 /******************************************************************************
- * renderScene: causes the environment to render each of the stored game 
- *    entities
- *    INPUT: dt: number of milliseconds elapsed since last render
+ * update: advances each of the stored game entities by one simulation
+ *    step, resolves collisions and spawns new waves
+ *    INPUT: dt: length of the step in seconds
  *****************************************************************************/
-void Environment::renderScene(float dt)
+void Environment::update(float dt)
 {
+   // Give the mixer a bigger buffer if it keeps missing its deadline
+   mAudioManager.adapt();
+
+   // Everything below sees the same input, whether live or replayed
+   readInput();
+
+   if (mInput & INPUT_MENU)
+      mMenuCountdown = (mMenuCountdown > 0) ? 0 : 5;
+   if (mInput & INPUT_PAUSE)
+      mPaused = !mPaused;
+
    // Check current status
    if (!mGameOver && mpShip == NULL)
    {
@@ -194,74 +393,104 @@ void Environment::renderScene(float dt)
       mShipCountdown -= dt;
    }
 
-   // Draw the background (bottommost layer)
-   mpBackground->draw(getXMax() / 2, getYMax() / 2, 0, dt);
-
-   // Update each object
-   for (list<Moveable*>::iterator it = mEntities.begin();
-      it != mEntities.end();)
+   if (!mGameOver && mMenuCountdown > 0)
    {
-      Moveable* p = (*it);
-
-      // Only advance when we're not paused
-      if (!mPaused && mMenuCountdown <= 0)
-	      *p += dt; //advance
-      p->draw(dt);
+      mMenuCountdown -= dt;
+   }
 
-      // detect collisions
-      for (list<Moveable*>::iterator it2 = mEntities.begin();
-         it2 != mEntities.end();
-         it2++)
-      {
-         Moveable* p2 = (*it2);
+   // Only advance when we're not paused
+   if (mPaused || mMenuCountdown > 0)
+      return;
 
-         if (p != p2 && p->getVector() - p2->getVector() 
-            <= (float)(p->getSize() + p2->getSize()))
+   // Move everything, then run each object's own behavior. Spawns are 
+   // only recorded, so the store keeps its size until applyCommands
+   {
+      PROFILE(PHASE_UPDATE);
+      mJobs.parallelFor(mEntities.size(), INTEGRATE_GRAIN, 
+         [&](int begin, int end)
          {
-            collide(p, p2);
-         }
-      }
+            mEntities.integrate(dt, getXMin(), getXMax(), getYMin(), getYMax(),
+                                begin, end);
+         });
 
-      // delete dead objects
-      if (p->isDead())
+      int count = mEntities.size();
+      for (int i = 0; i < count; i++)
       {
-         it = mEntities.erase(it);
-         delete p;
-      }
-      else
-      {
-         it++;
+         *mEntities.getOwner(i) += dt; //advance
       }
 
-		if (!mSaucerAttack)
+      mEffects.advance(dt);
+   }
+
+   // detect collisions, then act on them
+   {
+      PROFILE(PHASE_COLLISION);
+      detectCollisions();
+      resolveCollisions();
+   }
+
+   // delete dead objects and apply everything recorded this step
+   {
+      PROFILE(PHASE_UPDATE);
+      applyCommands();
+   }
+
+	if (!mSaucerAttack)
+	{
+		// Add new asteroids?
+		if (mAsteroidCount == 0 && mpShip)
 		{
-			// Add new asteroids?
-			if (mAsteroidCount == 0 && mpShip)
+			if (mWaveNumber % 2 == 1) //every other wave
+			{
+				saucerAttack(); //saucer counts as a wave
+			}
+			else
 			{
-				if (mWaveNumber % 2 == 1) //every other wave
-				{
-					saucerAttack(); //saucer counts as a wave
-				}
-				else
-				{
-					nextWave();
-				}
-
-				mWaveNumber++;
+				nextWave();
 			}
+
+			mWaveNumber++;
 		}
+	}
+}
+
+/******************************************************************************
+ * renderScene: causes the environment to render each of the stored game 
+ *    entities
+ *    INPUT: dt: number of seconds elapsed since last render
+ *****************************************************************************/
+void Environment::renderScene(float dt)
+{
+   // Draw the background (bottommost layer)
+   mpBackground->draw(getXMax() / 2, getYMax() / 2, 0, dt);
+   mGraphics.flushSprites();
+
+   // Draw each object (batched by texture, so in no particular order)
+   {
+      PROFILE(PHASE_DRAW);
+      for (int i = 0; i < mEntities.size(); i++)
+      {
+         mEntities.getOwner(i)->draw(dt);
+      }
+      mGraphics.flushSprites();
    }
 
    // Draw top-level menu items
    mpTopMenu->draw(getXMax() / 2, getYMax() - 12, 0, dt);
 
-   mGraphics.drawNumber(getXMin() + 125, getYMax() - 7, mGameScore, false);
-   mGraphics.drawNumber(getXMax() - 15, getYMax() - 7, mLivesRemaining, false);
+   {
+      PROFILE(PHASE_NUMBERS);
+      mGraphics.drawNumber(getXMin() + 125, getYMax() - 7, mGameScore, false);
+      mGraphics.drawNumber(getXMax() - 15, getYMax() - 7, mLivesRemaining, 
+                           false);
+
+      if (mShowProfile)
+         drawProfile();
+   }
 
    if (!mGameOver && mMenuCountdown > 0)
    {
       mpMenu->draw(getXMax() / 2, getYMax() / 2, 0, dt);
-      mMenuCountdown -= dt;
    }
    else if (mGameOver)
    {
@@ -269,82 +498,223 @@ void Environment::renderScene(float dt)
    }
 }
 
-void Environment::collide(Moveable * &m1, Moveable * &m2)
+/******************************************************************************
+ * drawProfile: draws the profiler's rolling statistics under the top menu,
+ *    one row per phase in ProfilePhase order (update, collision, draw, 
+ *    numbers, swap, frame) with min, avg and max in microseconds. The last
+ *    row is the audio callback: its deadline, avg and max in microseconds
+ *    and the number of underruns. Each row starts with its index, which
+ *    the legend printed when the overlay is first shown explains
+ *****************************************************************************/
+void Environment::drawProfile()
 {
-   switch(m1->getType())
+   for (int p = 0; p < PHASE_COUNT; p++)
    {
-      case 'b': //bullet
-         if (m2->getType() == 'r' &&
-             !(m1->isDead())) //check that bullet is unused (alive)
-         {
-            m1->kill(); //kill bullet
-            m2->kill(); //kill asteroid
-            mAsteroidCount--;
-         }
-			else if (m2->getType() == 'e' && !(m2->isDead()))
-         {
-            m1->kill(); //kill bullet
-            m2->kill(); //kill saucer
-            mSaucerAttack = false;
-				addPoint(10);
-         }
+      ProfilePhase phase = (ProfilePhase)p;
+      float y = getYMax() - 40 - p * 16;
+
+      // Each row starts with its number in the legend
+      mGraphics.drawNumber(getXMin() + 20,  y, p, false);
+      mGraphics.drawNumber(getXMin() + 60,  y, 
+                           (unsigned int)Profiler::getMin(phase), false);
+      mGraphics.drawNumber(getXMin() + 120, y,
+                           (unsigned int)Profiler::getAvg(phase), false);
+      mGraphics.drawNumber(getXMin() + 180, y,
+                           (unsigned int)Profiler::getMax(phase), false);
+   }
+
+   float y = getYMax() - 40 - PHASE_COUNT * 16;
+
+   mGraphics.drawNumber(getXMin() + 20,  y, PHASE_COUNT, false);
+   mGraphics.drawNumber(getXMin() + 60,  y, mAudioManager.getDeadline(),
+                        false);
+   mGraphics.drawNumber(getXMin() + 120, y, mAudioManager.getCallbackAvg(),
+                        false);
+   mGraphics.drawNumber(getXMin() + 180, y, mAudioManager.getCallbackMax(),
+                        false);
+   mGraphics.drawNumber(getXMin() + 240, y, mAudioManager.getUnderruns(),
+                        false);
+}
+
+/******************************************************************************
+ * detectCollisions: finds overlapping entities using the spatial grid as
+ *    a broadphase and fills the sorted contact list. Changes nothing
+ *****************************************************************************/
+void Environment::detectCollisions()
+{
+   // Find the largest collision radius
+   float maxSize = 1;
+   int   count   = mEntities.size();
+
+   for (int i = 0; i < count; i++)
+   {
+      if (mEntities.radius(i) > maxSize)
+         maxSize = mEntities.radius(i);
+   }
+
+   // Two entities can only touch if they are within one cell of each other
+   mGrid.reset(getXMax() - getXMin(), getYMax() - getYMin(), 2 * maxSize,
+               CAT_COUNT);
+
+   for (int i = 0; i < count; i++)
+   {
+      // Entities that interact with nothing (explosions) stay out of the 
+      // grid; the others are layered by category
+      Category category = mEntities.category(i);
+
+      if (collisionMask(category) != 0)
+         mGrid.insert(i, mEntities.x(i) - getXMin(), 
+                         mEntities.y(i) - getYMin(), category);
+   }
+
+   mGrid.build();
+
+   // Search bands of rows for candidates and keep the ones that actually
+   // overlap (narrowphase). Each band has its own lists, which are merged
+   // in band order, so the result is the same for any number of workers
+   int rows   = mGrid.getRows();
+   int grain  = rows;
+   if (count >= PARALLEL_ENTITIES)
+      grain = max(1, rows / (4 * mJobs.getWorkerCount()));
+
+   int chunks = (rows + grain - 1) / grain;
+   if ((int)mChunkPairs.size() < chunks)
+   {
+      mChunkPairs.resize(chunks);
+      mChunkContacts.resize(chunks);
+   }
+
+   mJobs.parallelFor(rows, grain, [&](int begin, int end)
+   {
+      vector<pair<int, int> > &pairs    = mChunkPairs[begin / grain];
+      vector<Contact>         &contacts = mChunkContacts[begin / grain];
+
+      pairs.clear();
+      contacts.clear();
+      mGrid.findPairs(pairs, begin, end, CollisionMaskTable::VALUES);
+      findContacts(mEntities, pairs, 0, (int)pairs.size(), contacts);
+   });
+
+   mContacts.clear();
+   for (int i = 0; i < chunks; i++)
+   {
+      mPairTests += (long)mChunkPairs[i].size();
+      mContacts.insert(mContacts.end(), mChunkContacts[i].begin(), 
+                       mChunkContacts[i].end());
+   }
+
+   mBruteForceTests += (long)count * (count - 1) / 2;
+
+   sortContacts(mContacts);
+}
+
+/******************************************************************************
+ * resolveCollisions: applies the collision rule for each contact, in 
+ *    contact list order
+ *****************************************************************************/
+void Environment::resolveCollisions()
+{
+   for (int i = 0; i < (int)mContacts.size(); i++)
+   {
+      int a = mContacts[i].a;
+      int b = mContacts[i].b;
+
+      // An entity that died earlier this step doesn't collide again
+      if (mEntities.dead(a) || mEntities.dead(b))
+         continue;
+
+      collisionHandler(mEntities.category(a), mEntities.category(b))
+         (this, mEntities.getOwner(a), mEntities.getOwner(b));
+   }
+}
+
+/******************************************************************************
+ * applyCommands: end-of-step phase. Deletes the dead entities (after letting
+ *    them record their death side effects), then applies every command 
+ *    recorded during the step in order
+ *****************************************************************************/
+void Environment::applyCommands()
+{
+   // From the back, so the slot moved into a hole has already been checked
+   for (int i = mEntities.size() - 1; i >= 0; i--)
+   {
+      if (mEntities.dead(i))
+      {
+         Moveable* p = mEntities.getOwner(i);
+         p->destroyed();
+         delete p;
+      }
+   }
+
+   for (int i = 0; i < mCommands.size(); i++)
+   {
+      const Command &command = mCommands[i];
+
+      switch (command.type)
+      {
+      case CMD_SPAWN:
+         spawn(this, command);
          break;
-      case 's': //ship
-         if (m2->getType() == 'r' && !(m1->isDead()))
-         {
-            m1->kill();    //kill ship
-            m2->kill();    //kill asteroid
-            mpShip = NULL; //clear ship pointer
-            mAsteroidCount--;
-         }
-			else if (m2->getType() == 'm' && !(m2->isDead()))
-         {
-            m1->kill();    //kill ship
-            m2->kill();    //kill missile
-            mpShip = NULL; //clear ship pointer
-         }
-			else if (m2->getType() == 'e' && !(m2->isDead()))
-         {
-            m1->kill();    // kill ship
-            m2->kill();    // kill saucer
-            mpShip = NULL; //clear ship pointer
-            mSaucerAttack = false;
-				addPoint(10);
-         }
+      case CMD_SCORE:
+         addPoint(command.value);
          break;
-      case 'r': //rock
-         if (m2->getType() == 'b' && !(m2->isDead()))
-         {
-            m1->kill(); //kill asteroid
-            m2->kill(); //kill bullet
-            mAsteroidCount--;
-         }
-         else if (m2->getType() == 's' && !(m2->isDead()))
-         {
-            m1->kill();    // kill asteroid
-            m2->kill();    // kill ship
-            mpShip = NULL; //clear ship pointer
-            mAsteroidCount--;
-         }
+      case CMD_ROCKS:
+         addRockNum(command.value);
          break;
-		case 'e': //enemy alien ship - immune to asteroids
-			if (m2->getType() == 'b' && !(m2->isDead()))
-         {
-            m1->kill(); //kill saucer
-            m2->kill(); //kill bullet
-            mSaucerAttack = false;
-				addPoint(10);
-         }
-         else if (m2->getType() == 's' && !(m2->isDead()))
-         {
-            m1->kill();    // kill saucer
-            m2->kill();    // kill ship
-            mpShip = NULL; //clear ship pointer
-            mSaucerAttack = false;
-				addPoint(10);
-         }
-			break;
-      default:
+      case CMD_PLAY:
+         mAudioManager.play(*command.pSound, command.value != 0);
+         break;
+      case CMD_STOP:
+         mAudioManager.stop(*command.pSound);
          break;
+      }
    }
-}
\ No newline at end of file
+
+   mCommands.clear();
+}
+
+/******************************************************************************
+ * Collision rules (declared in collision.h). Each one is written for the 
+ *    pair in category order; both entities are alive
+ *****************************************************************************/
+void CollisionRule<CAT_BULLET, CAT_ROCK>::resolve(Environment* pEnvironment,
+   Moveable* bullet, Moveable* rock)
+{
+   bullet->kill();
+   rock->kill();
+   pEnvironment->rockHit();
+}
+
+void CollisionRule<CAT_BULLET, CAT_SAUCER>::resolve(Environment* pEnvironment,
+   Moveable* bullet, Moveable* saucer)
+{
+   bullet->kill();
+   saucer->kill();
+   pEnvironment->saucerHit();
+}
+
+void CollisionRule<CAT_MISSILE, CAT_SHIP>::resolve(Environment* pEnvironment,
+   Moveable* missile, Moveable* ship)
+{
+   missile->kill();
+   ship->kill();
+   pEnvironment->shipHit();
+}
+
+void CollisionRule<CAT_ROCK, CAT_SHIP>::resolve(Environment* pEnvironment,
+   Moveable* rock, Moveable* ship)
+{
+   rock->kill();
+   ship->kill();
+   pEnvironment->rockHit();
+   pEnvironment->shipHit();
+}
+
+void CollisionRule<CAT_SHIP, CAT_SAUCER>::resolve(Environment* pEnvironment,
+   Moveable* ship, Moveable* saucer)
+{
+   ship->kill();
+   saucer->kill();
+   pEnvironment->shipHit();
+   pEnvironment->saucerHit();
+}
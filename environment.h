@@ -10,7 +10,16 @@
 #include "audio.h"
 #include "entity.h"
 #include "vector.h"
-#include <list>
+#include "grid.h"
+#include "store.h"
+#include "command.h"
+#include "collision.h"
+#include "jobs.h"
+#include "replay.h"
+#include "profiler.h"
+#include "random.h"
+#include "effect.h"
+#include <vector>
 
 /******************************************************************************
  * Macros for Sprites (SPR) and WAV files (WAV)
@@ -23,6 +32,14 @@
    #define WAV(name) (std::string("./sound/")  + (name) + ".wav")
 #endif
 
+/******************************************************************************
+ * Work splitting: below PARALLEL_ENTITIES entities a tick is too short to be
+ *    worth waking the workers; INTEGRATE_GRAIN entities are integrated per 
+ *    chunk
+ *****************************************************************************/
+#define PARALLEL_ENTITIES 1024
+#define INTEGRATE_GRAIN   4096
+
 /******************************************************************************
  * Forward declarations
  *****************************************************************************/
@@ -43,8 +60,23 @@ private:
    Moveable*            mpShip;
    Graphics             mGraphics;
 	AudioManager         mAudioManager;
-   std::list<Moveable*> mEntities;
+   EntityStore          mEntities;
+   CommandQueue         mCommands;
+   EffectTimeline       mEffects;
+   SpatialGrid          mGrid;
+   JobSystem            mJobs;
+   std::vector<std::vector<std::pair<int, int> > > mChunkPairs;
+   std::vector<std::vector<Contact> > mChunkContacts;
+   std::vector<Contact> mContacts;
+   long                 mPairTests;
+   long                 mBruteForceTests;
    bool                 mKeyStates[SDL_NUM_SCANCODES];
+   unsigned             mPresses;    // toggles pressed since the last tick
+   unsigned             mInput;      // INPUT_ bits for the current tick
+   Replay               mReplay;
+   Random               mRandom;     // seeded from mReplay
+   bool                 mReplaying;  // input comes from mReplay
+   std::string          mRecordFile; // where to save mReplay (if anywhere)
    int                  mAsteroidCount;
    int						mGameScore;
 	int						mWaveNumber;
@@ -54,14 +86,54 @@ private:
    float                mShipCountdown;
    bool                 mPaused;
    bool                 mGameOver;
+   bool                 mShowProfile; // 'o' toggles the profiler overlay
+   bool                 mProfileLegendShown; // printed on the console
+
+   /***************************************************************************
+    * update: advances each of the stored game entities by one simulation
+    *    step, resolves collisions and spawns new waves
+    *    INPUT: dt: length of the step in seconds
+    **************************************************************************/
+   virtual void update(float dt);
 
    /***************************************************************************
     * renderScene: causes the environment to render each of the stored game 
     *    entities and draws other graphical elements
-    *    INPUT: dt: number of milliseconds elapsed since last render
+    *    INPUT: dt: number of seconds elapsed since last render
     **************************************************************************/
    virtual void renderScene(float dt);
 
+   /***************************************************************************
+    * drawProfile: draws the profiler's min/avg/max for each phase, and the
+    *    audio callback's deadline, avg, max and underruns
+    **************************************************************************/
+   void drawProfile();
+
+   /***************************************************************************
+    * detectCollisions: finds overlapping entities using the spatial grid as
+    *    a broadphase and fills the sorted contact list. Changes nothing
+    **************************************************************************/
+   void detectCollisions();
+
+   /***************************************************************************
+    * resolveCollisions: applies the collision rule for each contact, in 
+    *    contact list order
+    **************************************************************************/
+   void resolveCollisions();
+
+   /***************************************************************************
+    * applyCommands: end-of-step phase. Deletes the dead entities (after
+    *    letting them record their death side effects), then applies every
+    *    command recorded during the step in order
+    **************************************************************************/
+   void applyCommands();
+
+   /***************************************************************************
+    * readInput: sets the input for the tick that is starting, either from 
+    *    the keyboard (recording it when asked to) or from the replay
+    **************************************************************************/
+   void readInput();
+
    /***************************************************************************
     * keyUp: triggered when a key is released
     *    INPUT: key: the ascii character value
@@ -76,7 +148,26 @@ private:
 
 public:
 
-   Environment(int argc, char* argv[]);
+   /***************************************************************************
+    * Environment:
+    *    INPUT: argc, argv: command line arguments. 
+    *                       --workers=N: number of threads the simulation
+    *                                    is split across (default 0, one 
+    *                                    per core)
+    *                       --seed=N   : random seed (default: the clock)
+    *                       --record=F : save the session's replay to F
+    *                       --replay=F : play the session back from F
+    *                       --profile=F: time each frame's phases and 
+    *                                    write them to F as CSV
+    *                       --audio-latency=MS: target audio latency
+    *                                    (default 25 ms)
+    *                       --audio-adaptive=0|1: whether the audio buffer
+    *                                    grows when callbacks miss
+    *                                    (default 1)
+    *           headless  : run without a window, OpenGL context or audio
+    *                       device (see simulate)
+    **************************************************************************/
+   Environment(int argc, char* argv[], bool headless = false);
    ~Environment();
 
    /***************************************************************************
@@ -90,6 +181,26 @@ public:
    Graphics*     getGraphics() { return &mGraphics;     }
    AudioManager* getAudio()    { return &mAudioManager; }
 
+   EntityStore*  getEntities() { return &mEntities;     }
+   CommandQueue* getCommands() { return &mCommands;     }
+   EffectTimeline* getEffects() { return &mEffects;     }
+   JobSystem*    getJobs()     { return &mJobs;         }
+   Replay*       getReplay()   { return &mReplay;       }
+   Random*       getRandom()   { return &mRandom;       }
+
+   int  getEntityCount() const { return mEntities.size(); }
+   int  getScore()       const { return mGameScore;            }
+   int  getWaveNumber()  const { return mWaveNumber;           }
+   bool isGameOver()     const { return mGameOver;             }
+   bool isReplaying()    const { return mReplaying;            }
+
+   /***************************************************************************
+    * Collision statistics: the number of distance tests actually performed
+    *    and the number the old all-pairs loop would have needed (totals)
+    **************************************************************************/
+   long getPairTests()       const { return mPairTests;       }
+   long getBruteForceTests() const { return mBruteForceTests; }
+
    /***************************************************************************
    * Setters
    ****************************************************************************/
@@ -97,15 +208,22 @@ public:
 	void addPoint(int num) { mGameScore += num; };
    void addRockNum(int num) { mAsteroidCount += num; };
 
+   /***************************************************************************
+    * Collision outcomes, called by the collision rules
+    **************************************************************************/
+   void rockHit()   { mAsteroidCount--; }
+   void shipHit()   { mpShip = NULL;    }
+   void saucerHit() { mSaucerAttack = false; mCommands.addScore(10); }
+
    /***************************************************************************
     * Key state checks
     **************************************************************************/
-   bool isSpace() const { return mKeyStates[SDL_SCANCODE_SPACE]; }
-   bool isLeft () const { return mKeyStates[SDL_SCANCODE_LEFT ]; }
-   bool isRight() const { return mKeyStates[SDL_SCANCODE_RIGHT]; }
-   bool isUp   () const { return mKeyStates[SDL_SCANCODE_UP   ]; }
-   bool isDown () const { return mKeyStates[SDL_SCANCODE_DOWN ]; }
-   bool isKey  (char c) const { return mKeyStates[SDL_GetScancodeFromKey(c)]; }
+   bool isSpace     () const { return (mInput & INPUT_SPACE     ) != 0; }
+   bool isLeft      () const { return (mInput & INPUT_LEFT      ) != 0; }
+   bool isRight     () const { return (mInput & INPUT_RIGHT     ) != 0; }
+   bool isUp        () const { return (mInput & INPUT_UP        ) != 0; }
+   bool isDown      () const { return (mInput & INPUT_DOWN      ) != 0; }
+   bool isHyperspace() const { return (mInput & INPUT_HYPERSPACE) != 0; }
 
    /***************************************************************************
     * start: starts the environment by running the message-processing loop
@@ -113,18 +231,18 @@ public:
    void start();
 
    /***************************************************************************
-    * add: adds a new entity to the environment
-    *    INPUT: pEntity: pointer to the entity
+    * simulate: runs the game logic for the given number of steps as fast as
+    *    the CPU allows (intended for headless environments)
+    *    INPUT : steps   : number of SIM_STEP updates to run
+    *    OUTPUT: <return>: wall-clock seconds taken
     **************************************************************************/
-   void add(Moveable* pEntity);
+   double simulate(int steps);
 
    void nextWave();
 
 	void saucerAttack();
 
    void addShip(bool subtractLife);
-
-   void collide(Moveable * &m1, Moveable * &m2);
 };
 
 #endif
\ No newline at end of file
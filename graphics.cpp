@@ -2,9 +2,9 @@
  * graphics.cpp: defines the methods for the Graphics class
  *****************************************************************************/
 #include "graphics.h"
+#include "sprite.h"
+#include "profiler.h"
 #include <GL/glu.h>
-#include <time.h>
-#include <sstream>
 using namespace std;
 
 /******************************************************************************
@@ -29,61 +29,46 @@ const char NUMBER_OUTLINES[10][20] =
 };
 
 /******************************************************************************
- * drawDigit: Draw a single digit in the old school line drawing style.  
- * The size of the glyph is 8x11 or x+(0..7), y+(0..10)
- *    INPUT: x    : x-coor of the upper left-hand corner
- *           y    : y-coor of the upper left-hand corner
- *           digit: single-character number
- *    NOTES: modifier from Br. Helfrich's uiDraw.h/cpp
+ * toDigits: writes a number's decimal digits, least significant first
+ *    INPUT : number: the number
+ *    OUTPUT: digits: 0..9 each (room for the 10 of the largest number)
+ *            <return>: how many digits were written
  *****************************************************************************/
-void drawDigit(float x, float y, char digit)
+static int toDigits(unsigned int number, char digits[10])
 {
-   // Lines won't display when textures are enabled
-   glDisable(GL_TEXTURE_2D);
-
-   // we better be only drawing digits
-   assert(isdigit(digit));
-   if (!isdigit(digit))
-      return;
-
-   // compute the row as specified by the digit
-   int r = digit - '0';
-   assert(r >= 0 && r <= 9);
+   int count = 0;
 
-   // go through each segment.
-   for (int c = 0; c < 20 && NUMBER_OUTLINES[r][c] != -1; c += 4)
+   do
    {
-      assert(NUMBER_OUTLINES[r][c    ] != -1 &&
-             NUMBER_OUTLINES[r][c + 1] != -1 &&
-             NUMBER_OUTLINES[r][c + 2] != -1 &&
-             NUMBER_OUTLINES[r][c + 3] != -1);
-
-      //Draw a line based off of the num structure for each number
-      glBegin(GL_LINES);
-
-      glVertex2f(x + NUMBER_OUTLINES[r][c],     y - NUMBER_OUTLINES[r][c + 1]);
-      glVertex2f(x + NUMBER_OUTLINES[r][c + 2], y - NUMBER_OUTLINES[r][c + 3]);
-
-      glEnd();
+      digits[count++] = (char)(number % 10);
+      number /= 10;
    }
+   while (number != 0);
 
-   glEnable(GL_TEXTURE_2D);
+   return count;
 }
 
 /******************************************************************************
  * Graphics:
- *    INPUT: width : width of the window
- *           height: height of the window
- *           title : title to display for the window
+ *    INPUT: width   : width of the window
+ *           height  : height of the window
+ *           title   : title to display for the window
+ *           headless: when true no window or OpenGL context is created
+ *                     and nothing is ever drawn
  *****************************************************************************/
-Graphics::Graphics(int width, int height, string title) 
-   : mWidth(width), mHeight(height), mIsRunning(true), mTitle(title)
+Graphics::Graphics(int width, int height, string title, bool headless) 
+   : mWidth(width), mHeight(height), mIsRunning(true), mHeadless(headless),
+     mTitle(title), mAccumulator(0)
 {
-   initVideo();
-   initOpenGL();
-   srand(time(NULL) / 2);
+   if (!mHeadless)
+   {
+      initVideo();
+      initOpenGL();
+   }
+
+   buildGlyphs();
 
-   mLastRenderTime = SDL_GetTicks();
+   mLastRenderTime = SDL_GetPerformanceCounter();
 }
 
 /******************************************************************************
@@ -97,14 +82,26 @@ Graphics::~Graphics()
    {
       delete iter->second;
    }
-   SDL_GL_DeleteContext(mGLContext);
-   SDL_DestroyWindow(mpWindow);
+   mAtlas.clear();
+
+   for (map<string, SpriteDef*>::iterator iter = mSpriteDefs.begin();
+      iter != mSpriteDefs.end(); iter++)
+   {
+      delete iter->second;
+   }
+
+   if (!mHeadless)
+   {
+      SDL_GL_DeleteContext(mGLContext);
+      SDL_DestroyWindow(mpWindow);
+   }
    SDL_Quit(); // Close the SDL window
 }
 
 /******************************************************************************
  * drawNumber: Display an positive integer on the screen using the 
- * 7-segment method
+ * 7-segment method. The number is drawn over the scene once the frame's
+ * renderScene returns
  *    INPUT: x     : x-coor of the upper left/right-hand corner
  *           y     : y-coor of the upper left/right-hand corner
  *           number: the number to draw
@@ -112,44 +109,120 @@ Graphics::~Graphics()
  *****************************************************************************/
 void Graphics::drawNumber(float x, float y, unsigned int number, bool rtl)
 {
-   // render the number as text
-   ostringstream sout;
-   sout << number;
-   string text = sout.str();
+   if (mHeadless)
+      return;
 
-   // walk through the text one digit at a time
-   if (rtl)
+   // The HUD draws the same few numbers in the same places every frame
+   for (int i = 0; i < mNumbers.size(); i++)
    {
-      for (int i = 0; i < text.length(); i++)
+      NumberMesh &mesh = mNumbers[i];
+      if (mesh.x == x && mesh.y == y && mesh.rtl == rtl)
       {
-         assert(isdigit(text[i]));
-         drawDigit(x, y, text[i]);
-         x += 11;
+         if (mesh.number != number)
+         {
+            mesh.number = number;
+            buildNumber(mesh);
+         }
+         mesh.drawn = true;
+         return;
       }
    }
-   else
+
+   NumberMesh mesh;
+   mesh.x      = x;
+   mesh.y      = y;
+   mesh.rtl    = rtl;
+   mesh.number = number;
+   mesh.drawn  = true;
+   mNumbers.push_back(mesh);
+   buildNumber(mNumbers.back());
+}
+
+/******************************************************************************
+ * buildGlyphs: turns NUMBER_OUTLINES into vertices, once. The glyph of a
+ *    digit is 8x11, x+(0..7), y-(0..10), from the upper left-hand corner
+ *****************************************************************************/
+void Graphics::buildGlyphs()
+{
+   mGlyphVertices.clear();
+
+   for (int r = 0; r < 10; r++)
+   {
+      mGlyphStart[r] = mGlyphVertices.size();
+
+      // go through each segment.
+      for (int c = 0; c < 20 && NUMBER_OUTLINES[r][c] != -1; c += 4)
+      {
+         assert(NUMBER_OUTLINES[r][c    ] != -1 &&
+                NUMBER_OUTLINES[r][c + 1] != -1 &&
+                NUMBER_OUTLINES[r][c + 2] != -1 &&
+                NUMBER_OUTLINES[r][c + 3] != -1);
+
+         mGlyphVertices.push_back( NUMBER_OUTLINES[r][c]);
+         mGlyphVertices.push_back(-NUMBER_OUTLINES[r][c + 1]);
+         mGlyphVertices.push_back( NUMBER_OUTLINES[r][c + 2]);
+         mGlyphVertices.push_back(-NUMBER_OUTLINES[r][c + 3]);
+      }
+   }
+
+   mGlyphStart[10] = mGlyphVertices.size();
+}
+
+/******************************************************************************
+ * buildNumber: lays out a number's digits into its mesh. Once the mesh has
+ *    held a number this long, nothing is allocated
+ *****************************************************************************/
+void Graphics::buildNumber(NumberMesh &mesh)
+{
+   char digits[10];
+   int  count = toDigits(mesh.number, digits);
+
+   mesh.vertices.clear();
+
+   // Left to right from x, or right to left from it
+   float x = mesh.rtl ? mesh.x + 11 * (count - 1) : mesh.x;
+
+   for (int i = 0; i < count; i++, x -= 11)
    {
-      for (int i = text.length() - 1; i >= 0; i--)
+      int d = digits[i];
+      for (int v = mGlyphStart[d]; v < mGlyphStart[d + 1]; v += 2)
       {
-         assert(isdigit(text[i]));
-         drawDigit(x, y, text[i]);
-         x -= 11;
+         mesh.vertices.push_back(x      + mGlyphVertices[v]);
+         mesh.vertices.push_back(mesh.y + mGlyphVertices[v + 1]);
       }
    }
 }
 
 /******************************************************************************
- * random: generates a random number between the given values (inclusive)
- *    INPUT: min: minimum value
- *           max: maximum value
- *    NOTES: modified from Br. Helfrich's uiDraw.cpp
+ * drawNumbers: draws every number requested this frame, one draw call 
+ *    each, with texturing turned off once for all of them
  *****************************************************************************/
-int Graphics::random(int min, int max)
+void Graphics::drawNumbers()
 {
-   assert(min <= max);
-   int num = (rand() % ((max + 1) - min)) + min;
-   assert(min <= num && num <= max);
-   return num;
+   bool any = false;
+   for (int i = 0; i < mNumbers.size() && !any; i++)
+      any = mNumbers[i].drawn;
+   if (!any)
+      return;
+
+   // Lines won't display when textures are enabled
+   glDisable(GL_TEXTURE_2D);
+   glEnableClientState(GL_VERTEX_ARRAY);
+
+   for (int i = 0; i < mNumbers.size(); i++)
+   {
+      NumberMesh &mesh = mNumbers[i];
+      if (!mesh.drawn)
+         continue;
+
+      glVertexPointer(2, GL_FLOAT, 0, mesh.vertices.data());
+      glDrawArrays(GL_LINES, 0, mesh.vertices.size() / 2);
+
+      mesh.drawn = false;
+   }
+
+   glDisableClientState(GL_VERTEX_ARRAY);
+   glEnable(GL_TEXTURE_2D);
 }
 
 /******************************************************************************
@@ -239,29 +312,83 @@ void Graphics::run(IGraphicsCallback *igraphics)
 }
 
 /******************************************************************************
- * renderScene: prepares the scene for rendering and calls the appropriate
- *    IGraphicsCallback interface to render the scene
+ * simulate: runs the given number of simulation steps as fast as 
+ *    possible, without waiting on the clock or processing any events
+ *    INPUT : igraphics: interface used to notify the parent of events
+ *            steps    : number of SIM_STEP updates to run
+ *    OUTPUT: <return> : wall-clock seconds taken
  *****************************************************************************/
-void Graphics::renderScene()
+double Graphics::simulate(IGraphicsCallback *igraphics, int steps)
 {
-   // Calculate the change in time (seconds), making sure it's significant
-   long time = 0;
-   float dt  = 0;
+   mpIGraphicsCallback = igraphics;
 
-   while (dt <= 0)
+   Uint64 start = SDL_GetPerformanceCounter();
+
+   for (int i = 0; i < steps; i++)
    {
-      time = SDL_GetTicks();
-      dt = (float)(time - mLastRenderTime) / 1000.0;
+      mpIGraphicsCallback->update(SIM_STEP);
+      Profiler::endFrame();
    }
 
-   // Clear the display buffers and render the scene
-   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+   return (double)(SDL_GetPerformanceCounter() - start) /
+          (double)SDL_GetPerformanceFrequency();
+}
+
+/******************************************************************************
+ * renderScene: runs the simulation steps that are due, then prepares the 
+ *    scene for rendering and calls the appropriate IGraphicsCallback 
+ *    interface to render the scene
+ *****************************************************************************/
+void Graphics::renderScene()
+{
+   // The frame's timers have to stop before it is recorded
+   {
+      PROFILE(PHASE_FRAME);
+
+      // Calculate the change in time (seconds) since the last frame
+      Uint64 time = SDL_GetPerformanceCounter();
+      float  dt   = (float)(time - mLastRenderTime) /
+                    (float)SDL_GetPerformanceFrequency();
+
+      mLastRenderTime = time;
+      mAccumulator   += dt;
+
+      // Advance the simulation in fixed steps
+      int steps = 0;
+
+      while (mAccumulator >= SIM_STEP && steps < MAX_STEPS_PER_FRAME)
+      {
+         mpIGraphicsCallback->update(SIM_STEP);
+         mAccumulator -= SIM_STEP;
+         steps++;
+      }
+
+      // Too far behind to catch up, drop the backlog
+      if (mAccumulator >= SIM_STEP)
+      {
+         mAccumulator = 0;
+      }
+
+      // Clear the display buffers and render the scene
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+      mpIGraphicsCallback->renderScene(dt);
+
+      {
+         PROFILE(PHASE_DRAW);
+         mSprites.flush();
+      }
+
+      {
+         PROFILE(PHASE_NUMBERS);
+         drawNumbers();
+      }
 
-   mpIGraphicsCallback->renderScene(dt);
-   
-   SDL_GL_SwapWindow(mpWindow);
+      PROFILE(PHASE_SWAP);
+      SDL_GL_SwapWindow(mpWindow);
+   }
 
-   mLastRenderTime = time;
+   Profiler::endFrame();
 }
 
 /******************************************************************************
@@ -270,8 +397,12 @@ void Graphics::renderScene()
  *    INPUT : filename: name of the texture to load
  *    OUTPUT: <return>: returns a pointer to the texture
  *****************************************************************************/
-Texture* Graphics::loadTexture(std::string filename)
+Texture* Graphics::loadTexture(const std::string &filename)
 {
+   Texture* pPacked = mAtlas.find(filename);
+   if (pPacked != NULL)
+      return pPacked;
+
    map<string, Texture*>::iterator iter = mTextures.find(filename);
 
    // Try to load the texture by name
@@ -284,7 +415,7 @@ Texture* Graphics::loadTexture(std::string filename)
    {
       try
       {
-         Texture* pTexture = new Texture(filename);
+         Texture* pTexture = new Texture(filename, !mHeadless);
 
          mTextures.insert(mTextures.begin(),
             std::pair<string, Texture*>(filename, pTexture));
@@ -297,3 +428,30 @@ Texture* Graphics::loadTexture(std::string filename)
       }
    }
 }
+
+/******************************************************************************
+ * loadSpriteDef: the shared definition of the sprites drawn from a sheet, 
+ *    made the first time it is asked for
+ *    INPUT : filename: name of the sheet's texture
+ *    OUTPUT: <return>: the definition (owned by Graphics)
+ *****************************************************************************/
+const SpriteDef* Graphics::loadSpriteDef(const std::string &filename)
+{
+   map<string, SpriteDef*>::iterator iter = mSpriteDefs.find(filename);
+   if (iter != mSpriteDefs.end())
+      return iter->second;
+
+   SpriteDef* pDef = new SpriteDef(loadTexture(filename));
+   mSpriteDefs[filename] = pDef;
+   return pDef;
+}
+
+/******************************************************************************
+ * buildAtlas: packs images into an atlas, so loadTexture hands out parts of
+ *    a shared texture for them. Call before they are first loaded
+ *    INPUT: filenames: the images (not ones used by a TilingSprite)
+ *****************************************************************************/
+void Graphics::buildAtlas(const vector<string> &filenames)
+{
+   mAtlas.build(filenames, !mHeadless);
+}
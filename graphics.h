@@ -10,8 +10,13 @@
 #include <GL/glu.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <ctime>
 #include "texture.h"
+#include "batch.h"
+#include "atlas.h"
+
+class SpriteDef;
 
 /******************************************************************************
  * IGraphicsCallback: callback interface used to notifiy client of graphcis
@@ -21,9 +26,15 @@ class IGraphicsCallback
 {
 public:
 
+   /***************************************************************************
+    * update: advances the simulation by one fixed step
+    *    INPUT: dt: length of the step in seconds (always SIM_STEP)
+    **************************************************************************/
+   virtual void update(float dt) = 0;
+
    /***************************************************************************
     * renderScene: triggers the renderScene event callback
-    *    INPUT: dt: number of milliseconds elapsed since last render
+    *    INPUT: dt: number of seconds elapsed since last render
     **************************************************************************/
    virtual void renderScene(float dt) = 0;
 
@@ -40,6 +51,16 @@ public:
    virtual void keyDown(SDL_Keycode key)   = 0;
 };
 
+/******************************************************************************
+ * Simulation clock: the game logic always advances in steps of SIM_STEP 
+ *    seconds, no matter how quickly frames are presented. At most 
+ *    MAX_STEPS_PER_FRAME steps are run per frame; anything beyond that is 
+ *    dropped so a long stall slows the game down instead of freezing it
+ *****************************************************************************/
+#define SIM_RATE            120
+#define SIM_STEP            (1.0f / SIM_RATE)
+#define MAX_STEPS_PER_FRAME 8
+
 /******************************************************************************
  * Graphics: interfaces with the SDL library to render graphics
  *****************************************************************************/
@@ -50,17 +71,57 @@ private:
    int                mWidth;
    int                mHeight;
    bool               mIsRunning;
+   bool               mHeadless;
    std::string        mTitle;
-   clock_t            mLastRenderTime;
+   Uint64             mLastRenderTime;
+   float              mAccumulator;
    IGraphicsCallback* mpIGraphicsCallback;
    SDL_Window*        mpWindow;
    SDL_GLContext      mGLContext;
 
-   std::map<std::string, Texture*> mTextures;
+   std::map<std::string, Texture*> mTextures; // the ones not in mAtlas
+   Atlas                           mAtlas;
+   std::map<std::string, SpriteDef*> mSpriteDefs;
+   SpriteBatch                     mSprites;
+
+   /***************************************************************************
+    * NumberMesh: the line segments of one number on the HUD, kept between
+    *    frames and only rebuilt when the number changes
+    **************************************************************************/
+   struct NumberMesh
+   {
+      float              x;
+      float              y;
+      bool               rtl;
+      unsigned int       number;
+      bool               drawn;    // requested this frame
+      std::vector<float> vertices; // x, y pairs, two per segment
+   };
+
+   std::vector<float>      mGlyphVertices; // every digit's segments
+   int                     mGlyphStart[11]; // digit d: [d] up to [d + 1]
+   std::vector<NumberMesh> mNumbers;
+
+   /***************************************************************************
+    * buildGlyphs: turns NUMBER_OUTLINES into vertices, once
+    **************************************************************************/
+   void buildGlyphs();
+
+   /***************************************************************************
+    * buildNumber: lays out a number's digits into its mesh
+    **************************************************************************/
+   void buildNumber(NumberMesh &mesh);
 
    /***************************************************************************
-    * renderScene: prepares the scene for rendering and calls the appropriate
-    *    IGraphicsCallback interface to render the scene
+    * drawNumbers: draws every number requested this frame, one draw call
+    *    each, with texturing turned off once for all of them
+    **************************************************************************/
+   void drawNumbers();
+
+   /***************************************************************************
+    * renderScene: runs the simulation steps that are due, then prepares the 
+    *    scene for rendering and calls the appropriate IGraphicsCallback 
+    *    interface to render the scene
     **************************************************************************/
    void renderScene();
 
@@ -80,11 +141,14 @@ public:
 
    /***************************************************************************
     * Graphics:
-    *    INPUT: width : width of the window
-    *           height: height of the window
-    *           title : title to display for the window
+    *    INPUT: width   : width of the window
+    *           height  : height of the window
+    *           title   : title to display for the window
+    *           headless: when true no window or OpenGL context is created
+    *                     and nothing is ever drawn
     **************************************************************************/
-   Graphics(int width = 200, int height = 200, std::string title = "");
+   Graphics(int width = 200, int height = 200, std::string title = "",
+      bool headless = false);
 
    /***************************************************************************
     * ~Graphics:
@@ -97,6 +161,7 @@ public:
    float getWidth()       const { return (float) mWidth; }
    float getHeight()      const { return (float)mHeight; }
    std::string getTitle() const { return         mTitle;  }
+   bool isHeadless()      const { return      mHeadless;  }
 
    /***************************************************************************
     * run: starts the graphics/event loop 
@@ -104,31 +169,60 @@ public:
     **************************************************************************/
    void run(IGraphicsCallback *igraphics);
 
+   /***************************************************************************
+    * simulate: runs the given number of simulation steps as fast as 
+    *    possible, without waiting on the clock or processing any events
+    *    INPUT : igraphics: interface used to notify the parent of events
+    *            steps    : number of SIM_STEP updates to run
+    *    OUTPUT: <return> : wall-clock seconds taken
+    **************************************************************************/
+   double simulate(IGraphicsCallback *igraphics, int steps);
+
    /***************************************************************************
     * loadTexture: attempts to load the given texture, first from from 
     *    memory, and if it hasn't been loaded previously, from the filesystem
     *    INPUT : filename: name of the texture to load
     *    OUTPUT: <return>: returns a pointer to the texture
     **************************************************************************/
-   Texture* loadTexture(std::string filename);
+   Texture* loadTexture(const std::string &filename);
 
    /***************************************************************************
-    * random: generates a random number between the given values (inclusive)
-    *    INPUT: min: minimum value
-    *           max: maximum value
-    *    NOTES: modified from Br. Helfrich's uiDraw.cpp
+    * loadSpriteDef: the shared definition of the sprites drawn from a sheet,
+    *    made the first time it is asked for
+    *    INPUT : filename: name of the sheet's texture
+    *    OUTPUT: <return>: the definition (owned by Graphics)
     **************************************************************************/
-   static int random(int min, int max);
+   const SpriteDef* loadSpriteDef(const std::string &filename);
+
+   /***************************************************************************
+    * buildAtlas: packs images into an atlas, so loadTexture hands out parts
+    *    of a shared texture for them. Call before they are first loaded
+    *    INPUT: filenames: the images (not ones used by a TilingSprite)
+    **************************************************************************/
+   void buildAtlas(const std::vector<std::string> &filenames);
 
    /***************************************************************************
     * drawNumber: Display an positive integer on the screen using the 
-    * 7-segment method
+    * 7-segment method. The number is drawn over the scene once the frame's
+    * renderScene returns
     *    INPUT: x     : x-coor of the upper left/right-hand corner
     *           y     : y-coor of the upper left/right-hand corner
     *           number: the number to draw
     *    NOTES: modified from Br. Helfrich's uiDraw.h/cpp
     **************************************************************************/
    void drawNumber(float x, float y, unsigned int number, bool rtl = true);
+
+   /***************************************************************************
+    * getSprites: the batch sprites are drawn into (flushed at the end of 
+    *    every frame)
+    **************************************************************************/
+   SpriteBatch* getSprites() { return &mSprites; }
+
+   /***************************************************************************
+    * flushSprites: draws the sprites batched so far, so that the ones that 
+    *    follow end up on top of them
+    **************************************************************************/
+   void flushSprites() { mSprites.flush(); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * grid.cpp: implements the SpatialGrid class
+ *****************************************************************************/
+#include "grid.h"
+#include <assert.h>
+#include <math.h>
+using namespace std;
+
+/******************************************************************************
+ * SpatialGrid:
+ *****************************************************************************/
+SpatialGrid::SpatialGrid()
+   : mWidth(0), mHeight(0), mCellSize(1), mColumns(1), mRows(1), 
+     mLayers(1), mPairTests(0)
+{
+}
+
+/******************************************************************************
+ * reset: clears the grid and resizes it for a new tick
+ *    INPUT: width   : width  of the area covered by the grid
+ *           height  : height of the area covered by the grid
+ *           cellSize: length of a cell's side; must be at least the 
+ *                     largest collision distance (sum of two radii)
+ *           layers  : number of layers points can be inserted into
+ *****************************************************************************/
+void SpatialGrid::reset(float width, float height, float cellSize, 
+   int layers)
+{
+   assert(width > 0 && height > 0 && layers > 0);
+
+   mWidth    = width;
+   mHeight   = height;
+   mCellSize = (cellSize < 1) ? 1 : cellSize;
+   mColumns  = (int)ceil(width  / mCellSize);
+   mRows     = (int)ceil(height / mCellSize);
+
+   if (mColumns < 1)
+      mColumns = 1;
+   if (mRows < 1)
+      mRows = 1;
+
+   mLayers = layers;
+
+   mIds.clear();
+   mCells.clear();
+   mSorted.clear();
+   mCellStart.assign(mColumns * mRows * mLayers + 1, 0);
+   mPairTests = 0;
+}
+
+/******************************************************************************
+ * cellOf: determines which column or row a coordinate falls into
+ *    INPUT : value: the x or y coordinate
+ *            count: number of columns or rows
+ *    OUTPUT: <return>: the clamped column or row
+ *****************************************************************************/
+int SpatialGrid::cellOf(float value, int count) const
+{
+   int cell = (int)floor(value / mCellSize);
+
+   // Entities sitting exactly on (or wrapping past) the edge share the 
+   // border cells
+   if (cell < 0)
+      cell = 0;
+   else if (cell >= count)
+      cell = count - 1;
+
+   return cell;
+}
+
+/******************************************************************************
+ * insert: adds a point to the grid
+ *    INPUT: id: identifier reported back by findPairs
+ *           x : x position, relative to the grid's origin
+ *           y : y position, relative to the grid's origin
+ *           layer: which layer the point belongs to
+ *****************************************************************************/
+void SpatialGrid::insert(int id, float x, float y, int layer)
+{
+   assert(layer >= 0 && layer < mLayers);
+
+   int cell   = cellOf(y, mRows) * mColumns + cellOf(x, mColumns);
+   int bucket = cell * mLayers + layer;
+
+   mIds.push_back(id);
+   mCells.push_back(bucket);
+   mCellStart[bucket + 1]++;
+}
+
+/******************************************************************************
+ * build: groups the inserted ids by cell and layer (counting sort). Must be
+ *    called after the last insert and before findPairs
+ *****************************************************************************/
+void SpatialGrid::build()
+{
+   // Turn the per-bucket counts into starting offsets
+   for (int c = 1; c < (int)mCellStart.size(); c++)
+   {
+      mCellStart[c] += mCellStart[c - 1];
+   }
+
+   // Scatter the ids into their buckets, preserving insertion order
+   mNext.assign(mCellStart.begin(), mCellStart.end() - 1);
+   mSorted.resize(mIds.size());
+
+   for (int i = 0; i < (int)mIds.size(); i++)
+   {
+      mSorted[mNext[mCells[i]]++] = mIds[i];
+   }
+}
+
+/******************************************************************************
+ * findPairs: collects every pair of ids in the same or adjacent cells. 
+ *    Each pair is reported once, with the smaller id first
+ *    INPUT : pairs: list to fill with candidate pairs (cleared first)
+ *            masks: for each layer, bit L is set if it interacts with layer 
+ *                   L (must be symmetric). NULL: all layers do
+ *****************************************************************************/
+void SpatialGrid::findPairs(vector<pair<int, int> > &pairs, 
+   const unsigned* masks)
+{
+   pairs.clear();
+   findPairs(pairs, 0, mRows, masks);
+
+   mPairTests = (int)pairs.size();
+}
+
+/******************************************************************************
+ * findPairs: collects the pairs whose first id lies in the given band of 
+ *    rows. Doesn't change the grid, so bands can be searched at the same time
+ *    INPUT : rowBegin, rowEnd: the band of rows [rowBegin, rowEnd)
+ *            masks           : layer interactions (as above)
+ *    OUTPUT: pairs           : candidate pairs, appended
+ *****************************************************************************/
+void SpatialGrid::findPairs(vector<pair<int, int> > &pairs, 
+                            int rowBegin, int rowEnd, 
+                            const unsigned* masks) const
+{
+   for (int row = rowBegin; row < rowEnd; row++)
+   {
+      for (int col = 0; col < mColumns; col++)
+      {
+         int cell = row * mColumns + col;
+
+         // Neighborhood of cells around this one (clamped at the edges)
+         int rowMin = (row > 0)            ? row - 1 : row;
+         int rowMax = (row < mRows - 1)    ? row + 1 : row;
+         int colMin = (col > 0)            ? col - 1 : col;
+         int colMax = (col < mColumns - 1) ? col + 1 : col;
+
+         for (int layer = 0; layer < mLayers; layer++)
+         {
+            int bucket = cell * mLayers + layer;
+
+            // Nothing here, or nothing this layer interacts with
+            if (mCellStart[bucket] == mCellStart[bucket + 1] ||
+                (masks != NULL && masks[layer] == 0))
+               continue;
+
+            for (int r = rowMin; r <= rowMax; r++)
+            {
+               for (int c = colMin; c <= colMax; c++)
+               {
+                  for (int other = 0; other < mLayers; other++)
+                  {
+                     if (masks != NULL && ((masks[layer] >> other) & 1) == 0)
+                        continue;
+
+                     int otherBucket = (r * mColumns + c) * mLayers + other;
+
+                     findBucketPairs(pairs, bucket, otherBucket);
+                  }
+               }
+            }
+         }
+      }
+   }
+}
+
+/******************************************************************************
+ * findBucketPairs: collects the pairs between two buckets
+ *    INPUT : bucket, other: the buckets (may be the same one)
+ *    OUTPUT: pairs        : candidate pairs, appended
+ *****************************************************************************/
+void SpatialGrid::findBucketPairs(vector<pair<int, int> > &pairs, 
+                                  int bucket, int other) const
+{
+   for (int i = mCellStart[bucket]; i < mCellStart[bucket + 1]; i++)
+   {
+      int a = mSorted[i];
+
+      for (int j = mCellStart[other]; j < mCellStart[other + 1]; j++)
+      {
+         // Only report each pair once
+         int b = mSorted[j];
+         if (a < b)
+         {
+            pairs.push_back(pair<int, int>(a, b));
+         }
+      }
+   }
+}
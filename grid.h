@@ -0,0 +1,115 @@
+/******************************************************************************
+ * grid.h: defines the SpatialGrid class, a uniform-grid spatial hash used as
+ *    the broadphase for collision detection
+ *****************************************************************************/
+#ifndef GRID_H
+#define GRID_H
+
+#include <vector>
+#include <utility>
+#include <stddef.h>
+
+/******************************************************************************
+ * SpatialGrid: buckets points into square cells so that only entities in 
+ *    neighboring cells need to be tested against each other. Within a cell
+ *    points are grouped by layer, so that groups of layers that never 
+ *    interact (rocks and rocks) are skipped without looking at their points.
+ *    The grid is rebuilt every tick: reset, insert every entity, build, then
+ *    findPairs
+ *****************************************************************************/
+class SpatialGrid
+{
+private:
+
+   float            mWidth;
+   float            mHeight;
+   float            mCellSize;
+   int              mColumns;
+   int              mRows;
+   int              mLayers;
+   int              mPairTests;
+   std::vector<int> mIds;       // ids in insertion order
+   std::vector<int> mCells;     // bucket (cell and layer) of each id
+   std::vector<int> mCellStart; // offset of each bucket's first id in mSorted
+   std::vector<int> mSorted;    // ids grouped by bucket
+   std::vector<int> mNext;      // scratch write offsets used by build
+
+   /***************************************************************************
+    * cellOf: determines which column or row a coordinate falls into
+    *    INPUT : value: the x or y coordinate
+    *            count: number of columns or rows
+    *    OUTPUT: <return>: the clamped column or row
+    **************************************************************************/
+   int cellOf(float value, int count) const;
+
+   /***************************************************************************
+    * findBucketPairs: collects the pairs between two buckets
+    *    INPUT : bucket, other: the buckets (may be the same one)
+    *    OUTPUT: pairs        : candidate pairs, appended
+    **************************************************************************/
+   void findBucketPairs(std::vector<std::pair<int, int> > &pairs, 
+                        int bucket, int other) const;
+
+public:
+
+   SpatialGrid();
+
+   /***************************************************************************
+    * reset: clears the grid and resizes it for a new tick
+    *    INPUT: width   : width  of the area covered by the grid
+    *           height  : height of the area covered by the grid
+    *           cellSize: length of a cell's side; must be at least the 
+    *                     largest collision distance (sum of two radii)
+    *           layers  : number of layers points can be inserted into
+    **************************************************************************/
+   void reset(float width, float height, float cellSize, int layers = 1);
+
+   /***************************************************************************
+    * insert: adds a point to the grid
+    *    INPUT: id: identifier reported back by findPairs
+    *           x : x position, relative to the grid's origin
+    *           y : y position, relative to the grid's origin
+    *           layer: which layer the point belongs to
+    **************************************************************************/
+   void insert(int id, float x, float y, int layer = 0);
+
+   /***************************************************************************
+    * build: groups the inserted ids by cell and layer (counting sort). Must
+    *    be called after the last insert and before findPairs
+    **************************************************************************/
+   void build();
+
+   /***************************************************************************
+    * findPairs: collects every pair of ids in the same or adjacent cells. 
+    *    Each pair is reported once, with the smaller id first
+    *    INPUT : pairs: list to fill with candidate pairs (cleared first)
+    *            masks: for each layer, bit L is set if it interacts with 
+    *                   layer L (must be symmetric). NULL: all layers do
+    **************************************************************************/
+   void findPairs(std::vector<std::pair<int, int> > &pairs, 
+                  const unsigned* masks = NULL);
+
+   /***************************************************************************
+    * findPairs: collects the pairs whose first id lies in the given band of
+    *    rows. Doesn't change the grid, so bands can be searched at the same
+    *    time; the bands' results, concatenated in row order, are exactly 
+    *    what the whole-grid findPairs reports
+    *    INPUT : rowBegin, rowEnd: the band of rows [rowBegin, rowEnd)
+    *            masks           : layer interactions (as above)
+    *    OUTPUT: pairs           : candidate pairs, appended
+    **************************************************************************/
+   void findPairs(std::vector<std::pair<int, int> > &pairs, 
+                  int rowBegin, int rowEnd, 
+                  const unsigned* masks = NULL) const;
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   int   getColumns()   const { return mColumns;   }
+   int   getRows()      const { return mRows;      }
+   int   getLayers()    const { return mLayers;    }
+   float getCellSize()  const { return mCellSize;  }
+   int   getPairTests() const { return mPairTests; }
+};
+
+#endif
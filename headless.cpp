@@ -0,0 +1,59 @@
+/******************************************************************************
+ * headless.cpp: runs the game logic without a window, OpenGL context or 
+ *    audio device and reports how many simulation ticks it can run per 
+ *    second. Usage: headless [ticks] [--workers=N] [--replay=F]
+ *    A replay is run for its recorded number of ticks unless ticks is given
+ *****************************************************************************/
+#include "environment.h"
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+using namespace std;
+
+/******************************************************************************
+ * main: steps a headless environment and prints the results
+ *****************************************************************************/
+int main(int argc, char* argv[])
+{
+   int ticks = 0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (argv[i][0] != '-')
+         ticks = atoi(argv[i]);
+   }
+
+   try
+   {
+      Environment environment(argc, argv, true);
+
+      if (ticks <= 0)
+      {
+         ticks = environment.isReplaying() ? 
+            environment.getReplay()->getTickCount() : 10000;
+      }
+
+      double seconds = environment.simulate(ticks);
+
+      cout << "workers:      " << environment.getJobs()->getWorkerCount() 
+           << endl
+           << "seed:         " << environment.getReplay()->getSeed() << endl
+           << "ticks:        " << ticks << endl
+           << "seconds:      " << seconds << endl
+           << "ticks/second: " << ticks / seconds << endl
+           << "entities:     " << environment.getEntityCount() << endl
+           << "waves:        " << environment.getWaveNumber() << endl
+           << "score:        " << environment.getScore() << endl
+           << "pair tests:   " << environment.getPairTests()
+           << " (all-pairs: " << environment.getBruteForceTests() << ")\n";
+
+      Pool::report(cout);
+   }
+   catch (string ex)
+   {
+      cerr << ex << endl;
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,166 @@
+/******************************************************************************
+ * jobs.cpp: implements the JobSystem class
+ *****************************************************************************/
+#include "jobs.h"
+using namespace std;
+
+/******************************************************************************
+ * JobSystem:
+ *    INPUT: workers: number of workers, including the calling thread
+ *                    (0 = one per hardware thread)
+ *****************************************************************************/
+JobSystem::JobSystem(int workers)
+   : mpTask(NULL), mRemaining(0), mGeneration(0), mQuit(false)
+{
+   if (workers <= 0)
+      workers = (int)thread::hardware_concurrency();
+
+   mWorkerCount = (workers > 0) ? workers : 1;
+
+   for (int i = 0; i < mWorkerCount; i++)
+      mQueues.push_back(new Queue);
+
+   for (int i = 1; i < mWorkerCount; i++)
+      mThreads.push_back(thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+   {
+      lock_guard<mutex> lock(mMutex);
+      mQuit = true;
+   }
+   mWake.notify_all();
+
+   for (int i = 0; i < (int)mThreads.size(); i++)
+      mThreads[i].join();
+
+   for (int i = 0; i < (int)mQueues.size(); i++)
+      delete mQueues[i];
+}
+
+/******************************************************************************
+ * parallelFor: runs task over [0, count) in chunks of grain indices and 
+ *    returns once every chunk is done
+ *    INPUT: count: number of indices
+ *           grain: indices per chunk
+ *           task : the work, called once per chunk
+ *****************************************************************************/
+void JobSystem::parallelFor(int count, int grain, const Task &task)
+{
+   if (count <= 0)
+      return;
+   if (grain < 1)
+      grain = 1;
+
+   int chunks = (count + grain - 1) / grain;
+
+   // Nothing to share: run the chunks in order on this thread
+   if (mWorkerCount == 1 || chunks == 1)
+   {
+      for (int begin = 0; begin < count; begin += grain)
+         task(begin, min(begin + grain, count));
+      return;
+   }
+
+   // Publish the task before any chunk can be seen by a worker
+   mpTask     = &task;
+   mRemaining = chunks;
+
+   // Deal the chunks out round-robin
+   for (int k = 0; k < chunks; k++)
+   {
+      Chunk chunk;
+      chunk.begin = k * grain;
+      chunk.end   = min(chunk.begin + grain, count);
+
+      Queue* pQueue = mQueues[k % mWorkerCount];
+      lock_guard<mutex> lock(pQueue->mutex);
+      pQueue->chunks.push_back(chunk);
+   }
+
+   {
+      lock_guard<mutex> lock(mMutex);
+      mGeneration++;
+   }
+   mWake.notify_all();
+
+   // Help out, then wait for the chunks still running on other workers
+   while (runOne(0))
+      ;
+
+   unique_lock<mutex> lock(mMutex);
+   while (mRemaining > 0)
+      mDone.wait(lock);
+}
+
+/******************************************************************************
+ * runOne: runs one chunk, from the worker's own queue or stolen
+ *    INPUT : worker  : the worker looking for work
+ *    OUTPUT: <return>: false if every queue was empty
+ *****************************************************************************/
+bool JobSystem::runOne(int worker)
+{
+   Chunk chunk;
+   bool  found = false;
+
+   // Own queue first (newest chunk), then steal (oldest chunk)
+   for (int i = 0; i < mWorkerCount && !found; i++)
+   {
+      Queue* pQueue = mQueues[(worker + i) % mWorkerCount];
+      lock_guard<mutex> lock(pQueue->mutex);
+
+      if (!pQueue->chunks.empty())
+      {
+         if (i == 0)
+         {
+            chunk = pQueue->chunks.back();
+            pQueue->chunks.pop_back();
+         }
+         else
+         {
+            chunk = pQueue->chunks.front();
+            pQueue->chunks.pop_front();
+         }
+         found = true;
+      }
+   }
+
+   if (!found)
+      return false;
+
+   (*mpTask)(chunk.begin, chunk.end);
+
+   if (--mRemaining == 0)
+   {
+      lock_guard<mutex> lock(mMutex);
+      mDone.notify_all();
+   }
+
+   return true;
+}
+
+/******************************************************************************
+ * workerLoop: body of the pool's threads
+ *****************************************************************************/
+void JobSystem::workerLoop(int worker)
+{
+   unsigned seen = 0;
+
+   for (;;)
+   {
+      {
+         unique_lock<mutex> lock(mMutex);
+         while (!mQuit && mGeneration == seen)
+            mWake.wait(lock);
+
+         if (mQuit)
+            return;
+
+         seen = mGeneration;
+      }
+
+      while (runOne(worker))
+         ;
+   }
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * jobs.h: defines the JobSystem class, a small work-stealing thread pool 
+ *    used to split the per-tick passes over the entities across cores
+ *****************************************************************************/
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/******************************************************************************
+ * JobSystem: runs the chunks of a parallelFor on a fixed set of workers. The
+ *    calling thread is worker 0 and the others are threads owned by the 
+ *    pool. Each worker has its own queue of chunks; it takes work from the
+ *    back of its own queue and, once that is empty, steals from the front of
+ *    the others'. With a single worker no threads are started and every 
+ *    chunk runs in order on the calling thread
+ *****************************************************************************/
+class JobSystem
+{
+public:
+
+   /***************************************************************************
+    * Task: the work for one chunk, the indices [begin, end)
+    **************************************************************************/
+   typedef std::function<void (int begin, int end)> Task;
+
+   /***************************************************************************
+    * JobSystem:
+    *    INPUT: workers: number of workers, including the calling thread
+    *                    (0 = one per hardware thread)
+    **************************************************************************/
+   JobSystem(int workers = 0);
+   ~JobSystem();
+
+   int getWorkerCount() const { return mWorkerCount; }
+
+   /***************************************************************************
+    * parallelFor: runs task over [0, count) in chunks of grain indices and 
+    *    returns once every chunk is done. Chunk k covers 
+    *    [k * grain, min((k + 1) * grain, count)), so begin / grain is the 
+    *    chunk's index; tasks that write to per-chunk outputs get the same
+    *    results no matter which worker ran which chunk. Not reentrant
+    *    INPUT: count: number of indices
+    *           grain: indices per chunk
+    *           task : the work, called once per chunk
+    **************************************************************************/
+   void parallelFor(int count, int grain, const Task &task);
+
+private:
+
+   struct Chunk
+   {
+      int begin;
+      int end;
+   };
+
+   struct Queue
+   {
+      std::mutex        mutex;
+      std::deque<Chunk> chunks;
+   };
+
+   int                      mWorkerCount;
+   std::vector<std::thread> mThreads;    // workers 1 .. mWorkerCount - 1
+   std::vector<Queue*>      mQueues;     // one per worker
+   const Task*              mpTask;      // task of the running parallelFor
+   std::atomic<int>         mRemaining;  // chunks not yet finished
+   std::mutex               mMutex;      // guards mGeneration and mQuit
+   std::condition_variable  mWake;       // a parallelFor has started
+   std::condition_variable  mDone;       // mRemaining reached 0
+   unsigned                 mGeneration; // number of parallelFors started
+   bool                     mQuit;
+
+   /***************************************************************************
+    * runOne: runs one chunk, from the worker's own queue or stolen
+    *    INPUT : worker  : the worker looking for work
+    *    OUTPUT: <return>: false if every queue was empty
+    **************************************************************************/
+   bool runOne(int worker);
+
+   /***************************************************************************
+    * workerLoop: body of the pool's threads
+    **************************************************************************/
+   void workerLoop(int worker);
+};
+
+#endif
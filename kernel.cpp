@@ -0,0 +1,192 @@
+/******************************************************************************
+ * kernel.cpp: implements the batched EntityStore kernels
+ *****************************************************************************/
+#include "kernel.h"
+
+#ifdef KERNEL_X86
+   #include <immintrin.h>
+#endif
+
+/******************************************************************************
+ * advanceScalar: one entity at a time. Also finishes the entities left over
+ *    by the wider kernels
+ *****************************************************************************/
+void advanceScalar(float* x, float* y, const float* dx, const float* dy, 
+                   int count, float dt, float xMin, float xMax, 
+                   float yMin, float yMax)
+{
+   for (int i = 0; i < count; i++)
+   {
+      float newX = x[i] + dx[i] * dt;
+      float newY = y[i] + dy[i] * dt;
+
+      if (newX > xMax)
+         newX = xMin;
+      if (newX < xMin)
+         newX = xMax;
+      if (newY > yMax)
+         newY = yMin;
+      if (newY < yMin)
+         newY = yMax;
+
+      x[i] = newX;
+      y[i] = newY;
+   }
+}
+
+#ifdef KERNEL_X86
+
+/******************************************************************************
+ * wrapSSE: the scalar wrap, four lanes at a time (SSE has no blend, so the
+ *    select is done with and/andnot/or)
+ *****************************************************************************/
+__attribute__((target("sse")))
+static inline __m128 wrapSSE(__m128 value, __m128 low, __m128 high)
+{
+   __m128 over  = _mm_cmpgt_ps(value, high);
+   value = _mm_or_ps(_mm_and_ps(over, low), _mm_andnot_ps(over, value));
+
+   __m128 under = _mm_cmplt_ps(value, low);
+   return _mm_or_ps(_mm_and_ps(under, high), _mm_andnot_ps(under, value));
+}
+
+/******************************************************************************
+ * advanceSSE: four entities at a time
+ *****************************************************************************/
+__attribute__((target("sse")))
+void advanceSSE(float* x, float* y, const float* dx, const float* dy, 
+                int count, float dt, float xMin, float xMax, 
+                float yMin, float yMax)
+{
+   __m128 step  = _mm_set1_ps(dt);
+   __m128 left  = _mm_set1_ps(xMin);
+   __m128 right = _mm_set1_ps(xMax);
+   __m128 down  = _mm_set1_ps(yMin);
+   __m128 up    = _mm_set1_ps(yMax);
+
+   int i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 newX = _mm_add_ps(_mm_loadu_ps(x + i), 
+                               _mm_mul_ps(_mm_loadu_ps(dx + i), step));
+      __m128 newY = _mm_add_ps(_mm_loadu_ps(y + i), 
+                               _mm_mul_ps(_mm_loadu_ps(dy + i), step));
+
+      _mm_storeu_ps(x + i, wrapSSE(newX, left, right));
+      _mm_storeu_ps(y + i, wrapSSE(newY, down, up));
+   }
+
+   advanceScalar(x + i, y + i, dx + i, dy + i, count - i, 
+                 dt, xMin, xMax, yMin, yMax);
+}
+
+/******************************************************************************
+ * wrapAVX: the scalar wrap, eight lanes at a time. The select is 
+ *    and/andnot/or so it reads step for step like wrapSSE; 
+ *    _mm256_blendv_ps would give the same result
+ *****************************************************************************/
+__attribute__((target("avx")))
+static inline __m256 wrapAVX(__m256 value, __m256 low, __m256 high)
+{
+   __m256 over  = _mm256_cmp_ps(value, high, _CMP_GT_OQ);
+   value = _mm256_or_ps(_mm256_and_ps(over, low), 
+                        _mm256_andnot_ps(over, value));
+
+   __m256 under = _mm256_cmp_ps(value, low, _CMP_LT_OQ);
+   return _mm256_or_ps(_mm256_and_ps(under, high), 
+                       _mm256_andnot_ps(under, value));
+}
+
+/******************************************************************************
+ * advanceAVX: eight entities at a time
+ *****************************************************************************/
+__attribute__((target("avx")))
+void advanceAVX(float* x, float* y, const float* dx, const float* dy, 
+                int count, float dt, float xMin, float xMax, 
+                float yMin, float yMax)
+{
+   __m256 step  = _mm256_set1_ps(dt);
+   __m256 left  = _mm256_set1_ps(xMin);
+   __m256 right = _mm256_set1_ps(xMax);
+   __m256 down  = _mm256_set1_ps(yMin);
+   __m256 up    = _mm256_set1_ps(yMax);
+
+   int i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      __m256 newX = _mm256_add_ps(_mm256_loadu_ps(x + i), 
+                                  _mm256_mul_ps(_mm256_loadu_ps(dx + i), step));
+      __m256 newY = _mm256_add_ps(_mm256_loadu_ps(y + i), 
+                                  _mm256_mul_ps(_mm256_loadu_ps(dy + i), step));
+
+      _mm256_storeu_ps(x + i, wrapAVX(newX, left, right));
+      _mm256_storeu_ps(y + i, wrapAVX(newY, down, up));
+   }
+
+   advanceScalar(x + i, y + i, dx + i, dy + i, count - i, 
+                 dt, xMin, xMax, yMin, yMax);
+}
+
+#endif // KERNEL_X86
+
+/******************************************************************************
+ * getKernelLevel: the best level this CPU supports
+ *****************************************************************************/
+KernelLevel getKernelLevel()
+{
+#ifdef KERNEL_X86
+   __builtin_cpu_init();
+
+   if (__builtin_cpu_supports("avx"))
+      return KERNEL_AVX;
+   if (__builtin_cpu_supports("sse"))
+      return KERNEL_SSE;
+#endif
+   return KERNEL_SCALAR;
+}
+
+/******************************************************************************
+ * getKernelName: a printable name for a level
+ *****************************************************************************/
+const char* getKernelName(KernelLevel level)
+{
+   switch (level)
+   {
+   case KERNEL_AVX:
+      return "avx";
+   case KERNEL_SSE:
+      return "sse";
+   default:
+      return "scalar";
+   }
+}
+
+/******************************************************************************
+ * getAdvanceKernel: the advance kernel for a level, or for the best level 
+ *    below it when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+AdvanceKernel getAdvanceKernel(KernelLevel level)
+{
+   if (level > getKernelLevel())
+      level = getKernelLevel();
+
+#ifdef KERNEL_X86
+   if (level == KERNEL_AVX)
+      return advanceAVX;
+   if (level == KERNEL_SSE)
+      return advanceSSE;
+#endif
+   return advanceScalar;
+}
+
+/******************************************************************************
+ * advance: runs the best advance kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void advance(float* x, float* y, const float* dx, const float* dy, 
+             int count, float dt, float xMin, float xMax, 
+             float yMin, float yMax)
+{
+   static AdvanceKernel kernel = getAdvanceKernel(getKernelLevel());
+
+   kernel(x, y, dx, dy, count, dt, xMin, xMax, yMin, yMax);
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * kernel.h: defines the batched kernels that run over the EntityStore 
+ *    arrays, with SSE and AVX versions picked at runtime
+ *****************************************************************************/
+#ifndef KERNEL_H
+#define KERNEL_H
+
+/******************************************************************************
+ * KERNEL_X86: defined when the SSE and AVX kernels are compiled in
+ *****************************************************************************/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   #define KERNEL_X86
+#endif
+
+/******************************************************************************
+ * KernelLevel: which instruction set a kernel uses
+ *****************************************************************************/
+enum KernelLevel
+{
+   KERNEL_SCALAR,
+   KERNEL_SSE,   // 4 entities at a time
+   KERNEL_AVX    // 8 entities at a time
+};
+
+/******************************************************************************
+ * AdvanceKernel: moves count entities along their velocity and wraps them
+ *    around the screen (a wrapped entity reappears on the opposite edge)
+ *    INPUT : dx, dy    : velocities
+ *            count     : number of entities
+ *            dt        : the amount of time that has passed, in seconds
+ *            xMin, xMax: horizontal bounds of the screen
+ *            yMin, yMax: vertical bounds of the screen
+ *    OUTPUT: x, y      : positions, updated in place
+ *****************************************************************************/
+typedef void (*AdvanceKernel)(float* x, float* y, 
+                              const float* dx, const float* dy, int count,
+                              float dt, float xMin, float xMax, 
+                              float yMin, float yMax);
+
+/******************************************************************************
+ * The kernel for each level. All of them give bit-identical results
+ *****************************************************************************/
+void advanceScalar(float* x, float* y, const float* dx, const float* dy, 
+                   int count, float dt, float xMin, float xMax, 
+                   float yMin, float yMax);
+#ifdef KERNEL_X86
+void advanceSSE   (float* x, float* y, const float* dx, const float* dy, 
+                   int count, float dt, float xMin, float xMax, 
+                   float yMin, float yMax);
+void advanceAVX   (float* x, float* y, const float* dx, const float* dy, 
+                   int count, float dt, float xMin, float xMax, 
+                   float yMin, float yMax);
+#endif
+
+/******************************************************************************
+ * getKernelLevel: the best level this CPU supports
+ *****************************************************************************/
+KernelLevel getKernelLevel();
+
+/******************************************************************************
+ * getKernelName: a printable name for a level
+ *****************************************************************************/
+const char* getKernelName(KernelLevel level);
+
+/******************************************************************************
+ * getAdvanceKernel: the advance kernel for a level, or for the best level 
+ *    below it when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+AdvanceKernel getAdvanceKernel(KernelLevel level);
+
+/******************************************************************************
+ * advance: runs the best advance kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void advance(float* x, float* y, const float* dx, const float* dy, 
+             int count, float dt, float xMin, float xMax, 
+             float yMin, float yMax);
+
+#endif
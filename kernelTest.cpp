@@ -0,0 +1,115 @@
+/******************************************************************************
+ * kernelTest.cpp: checks that every advance kernel matches the scalar one 
+ *    and reports how many entities per microsecond each of them advances
+ *****************************************************************************/
+#include "kernel.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <time.h>
+using namespace std;
+
+void fill(vector<float> &x, vector<float> &y, 
+          vector<float> &dx, vector<float> &dy, int count);
+bool testMatches(KernelLevel level, int count);
+double testSpeed(KernelLevel level, int count, int ticks);
+
+int main()
+{
+   int sizes[] = { 1000, 10000, 100000 };
+   KernelLevel best = getKernelLevel();
+
+   srand(1);
+
+   cout << "best kernel: " << getKernelName(best) << endl;
+
+   cout << setw(10) << "entities" << setw(10) << "kernel"
+        << setw(18) << "entities/us" << setw(10) << "matches\n";
+
+   bool pass = true;
+   for (int i = 0; i < 3; i++)
+   {
+      int ticks = 100000000 / sizes[i];
+
+      for (int level = KERNEL_SCALAR; level <= best; level++)
+      {
+         bool matches = testMatches((KernelLevel)level, sizes[i]);
+         pass = pass && matches;
+
+         cout << setw(10) << sizes[i]
+              << setw(10) << getKernelName((KernelLevel)level)
+              << setw(18) << fixed << setprecision(1)
+              << testSpeed((KernelLevel)level, sizes[i], ticks)
+              << setw(9)  << (matches ? "yes" : "NO") << endl;
+      }
+   }
+
+   return pass ? 0 : 1;
+}
+
+/******************************************************************************
+ * fill: entities all over the screen (and some just off it, so every 
+ *    wrap case is hit) drifting in all directions
+ *****************************************************************************/
+void fill(vector<float> &x, vector<float> &y, 
+          vector<float> &dx, vector<float> &dy, int count)
+{
+   x.resize(count);
+   y.resize(count);
+   dx.resize(count);
+   dy.resize(count);
+
+   for (int i = 0; i < count; i++)
+   {
+      x[i]  = rand() % 420 - 10;
+      y[i]  = rand() % 420 - 10;
+      dx[i] = rand() % 1000 - 500;
+      dy[i] = rand() % 1000 - 500;
+   }
+}
+
+/******************************************************************************
+ * testMatches: runs a kernel and the scalar kernel over the same entities
+ *    for a few ticks and compares the positions bit for bit
+ *****************************************************************************/
+bool testMatches(KernelLevel level, int count)
+{
+   vector<float> x, y, dx, dy;
+   fill(x, y, dx, dy, count);
+
+   vector<float> x2 = x;
+   vector<float> y2 = y;
+
+   AdvanceKernel kernel = getAdvanceKernel(level);
+   for (int t = 0; t < 100; t++)
+   {
+      kernel(x.data(), y.data(), dx.data(), dy.data(), count, 
+             1.0f / 120, 0, 400, 0, 400);
+      advanceScalar(x2.data(), y2.data(), dx.data(), dy.data(), count, 
+                    1.0f / 120, 0, 400, 0, 400);
+   }
+
+   return x == x2 && y == y2;
+}
+
+/******************************************************************************
+ * testSpeed: entities advanced per microsecond by a kernel
+ *****************************************************************************/
+double testSpeed(KernelLevel level, int count, int ticks)
+{
+   vector<float> x, y, dx, dy;
+   fill(x, y, dx, dy, count);
+
+   AdvanceKernel kernel = getAdvanceKernel(level);
+
+   clock_t start = clock();
+   for (int t = 0; t < ticks; t++)
+   {
+      kernel(x.data(), y.data(), dx.data(), dy.data(), count, 
+             1.0f / 120, 0, 400, 0, 400);
+   }
+   double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   return (double)count * ticks / (seconds * 1e6);
+}
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * mixer.cpp: implements the mixing kernels
+ *****************************************************************************/
+#include "mixer.h"
+
+#ifdef KERNEL_X86
+   #include <immintrin.h>
+#endif
+
+/******************************************************************************
+ * mixScalar: one sample at a time. Also finishes the samples left over by
+ *    the wider kernels
+ *****************************************************************************/
+void mixScalar(int* accumulator, const Sint16* samples, int count, int volume)
+{
+   for (int i = 0; i < count; i++)
+      accumulator[i] += samples[i] * volume;
+}
+
+/******************************************************************************
+ * saturateScalar: one sample at a time
+ *****************************************************************************/
+void saturateScalar(Sint16* samples, const int* accumulator, int count)
+{
+   for (int i = 0; i < count; i++)
+   {
+      int sample = accumulator[i] >> MIX_SHIFT;
+
+      if (sample > 32767)
+         sample = 32767;
+      else if (sample < -32768)
+         sample = -32768;
+
+      samples[i] = (Sint16)sample;
+   }
+}
+
+#ifdef KERNEL_X86
+
+/******************************************************************************
+ * mixSSE: eight samples at a time. SSE2 has no 32 bit multiply, so each
+ *    sample is paired with a zero and multiplied by (volume, 0) with madd
+ *****************************************************************************/
+__attribute__((target("sse2")))
+void mixSSE(int* accumulator, const Sint16* samples, int count, int volume)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i v    = _mm_set1_epi32(volume);
+
+   int i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      __m128i s  = _mm_loadu_si128((const __m128i*)(samples + i));
+      __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(s, zero), v);
+      __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(s, zero), v);
+
+      __m128i* a = (__m128i*)(accumulator + i);
+      _mm_storeu_si128(a,     _mm_add_epi32(_mm_loadu_si128(a),     lo));
+      _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), hi));
+   }
+
+   mixScalar(accumulator + i, samples + i, count - i, volume);
+}
+
+/******************************************************************************
+ * saturateSSE: eight samples at a time (packs clamps for us)
+ *****************************************************************************/
+__attribute__((target("sse2")))
+void saturateSSE(Sint16* samples, const int* accumulator, int count)
+{
+   int i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      const __m128i* a = (const __m128i*)(accumulator + i);
+      __m128i lo = _mm_srai_epi32(_mm_loadu_si128(a),     MIX_SHIFT);
+      __m128i hi = _mm_srai_epi32(_mm_loadu_si128(a + 1), MIX_SHIFT);
+
+      _mm_storeu_si128((__m128i*)(samples + i), _mm_packs_epi32(lo, hi));
+   }
+
+   saturateScalar(samples + i, accumulator + i, count - i);
+}
+
+/******************************************************************************
+ * mixAVX: sixteen samples at a time
+ *****************************************************************************/
+__attribute__((target("avx2")))
+void mixAVX(int* accumulator, const Sint16* samples, int count, int volume)
+{
+   const __m256i v = _mm256_set1_epi32(volume);
+
+   int i = 0;
+   for (; i + 16 <= count; i += 16)
+   {
+      const __m128i* s = (const __m128i*)(samples + i);
+      __m256i lo = _mm256_mullo_epi32(
+         _mm256_cvtepi16_epi32(_mm_loadu_si128(s)), v);
+      __m256i hi = _mm256_mullo_epi32(
+         _mm256_cvtepi16_epi32(_mm_loadu_si128(s + 1)), v);
+
+      __m256i* a = (__m256i*)(accumulator + i);
+      _mm256_storeu_si256(a,
+         _mm256_add_epi32(_mm256_loadu_si256(a),     lo));
+      _mm256_storeu_si256(a + 1,
+         _mm256_add_epi32(_mm256_loadu_si256(a + 1), hi));
+   }
+
+   mixScalar(accumulator + i, samples + i, count - i, volume);
+}
+
+/******************************************************************************
+ * saturateAVX: sixteen samples at a time. packs works within each 128 bit
+ *    half, so the quarters are put back in order afterwards
+ *****************************************************************************/
+__attribute__((target("avx2")))
+void saturateAVX(Sint16* samples, const int* accumulator, int count)
+{
+   int i = 0;
+   for (; i + 16 <= count; i += 16)
+   {
+      const __m256i* a = (const __m256i*)(accumulator + i);
+      __m256i lo = _mm256_srai_epi32(_mm256_loadu_si256(a),     MIX_SHIFT);
+      __m256i hi = _mm256_srai_epi32(_mm256_loadu_si256(a + 1), MIX_SHIFT);
+
+      __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi),
+                                                _MM_SHUFFLE(3, 1, 2, 0));
+      _mm256_storeu_si256((__m256i*)(samples + i), packed);
+   }
+
+   saturateScalar(samples + i, accumulator + i, count - i);
+}
+
+#endif // KERNEL_X86
+
+/******************************************************************************
+ * getMixLevel: the level the mixing kernels can run at. Their KERNEL_AVX
+ *    versions need AVX2 and their KERNEL_SSE versions SSE2
+ *****************************************************************************/
+static KernelLevel getMixLevel(KernelLevel level)
+{
+   if (level > getKernelLevel())
+      level = getKernelLevel();
+
+#ifdef KERNEL_X86
+   if (level == KERNEL_AVX && !__builtin_cpu_supports("avx2"))
+      level = KERNEL_SSE;
+   if (level == KERNEL_SSE && !__builtin_cpu_supports("sse2"))
+      level = KERNEL_SCALAR;
+#endif
+   return level;
+}
+
+/******************************************************************************
+ * getMixKernel: the kernel for a level, or for the best level below it
+ *    when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+MixKernel getMixKernel(KernelLevel level)
+{
+   level = getMixLevel(level);
+
+#ifdef KERNEL_X86
+   if (level == KERNEL_AVX)
+      return mixAVX;
+   if (level == KERNEL_SSE)
+      return mixSSE;
+#endif
+   return mixScalar;
+}
+
+/******************************************************************************
+ * getSaturateKernel: the kernel for a level, or for the best level below it
+ *    when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+SaturateKernel getSaturateKernel(KernelLevel level)
+{
+   level = getMixLevel(level);
+
+#ifdef KERNEL_X86
+   if (level == KERNEL_AVX)
+      return saturateAVX;
+   if (level == KERNEL_SSE)
+      return saturateSSE;
+#endif
+   return saturateScalar;
+}
+
+/******************************************************************************
+ * mix: runs the best mixing kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void mix(int* accumulator, const Sint16* samples, int count, int volume)
+{
+   static MixKernel kernel = getMixKernel(getKernelLevel());
+
+   kernel(accumulator, samples, count, volume);
+}
+
+/******************************************************************************
+ * saturate: runs the best saturating kernel for this CPU (chosen on first
+ *    use)
+ *****************************************************************************/
+void saturate(Sint16* samples, const int* accumulator, int count)
+{
+   static SaturateKernel kernel = getSaturateKernel(getKernelLevel());
+
+   kernel(samples, accumulator, count);
+}
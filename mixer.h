@@ -0,0 +1,69 @@
+/******************************************************************************
+ * mixer.h: defines the kernels the AudioManager mixes voices with. Every
+ *    voice is added into one 32 bit accumulator, which is brought back to
+ *    16 bit samples (AUDIO_S16) once, when every voice is in
+ *****************************************************************************/
+#ifndef MIXER_H
+#define MIXER_H
+
+#include "kernel.h"
+#include <SDL2/SDL.h>
+
+/******************************************************************************
+ * MIX_SHIFT: the accumulator holds samples times their volume, so the sum
+ *    is shifted down by log2(SDL_MIX_MAXVOLUME) at the end. 32 full-volume
+ *    voices at full scale fit in the accumulator with room to spare
+ *****************************************************************************/
+#define MIX_SHIFT 7
+
+/******************************************************************************
+ * MixKernel: adds count samples, scaled by volume, into the accumulator
+ *    INPUT : samples    : 16 bit samples
+ *            count      : number of samples
+ *            volume     : 0 to SDL_MIX_MAXVOLUME
+ *    OUTPUT: accumulator: count sums, updated in place
+ *****************************************************************************/
+typedef void (*MixKernel)(int* accumulator, const Sint16* samples, int count,
+                          int volume);
+
+/******************************************************************************
+ * SaturateKernel: brings the accumulator back to 16 bit samples, clamping
+ *    the ones that overflow
+ *    INPUT : accumulator: count sums
+ *            count      : number of samples
+ *    OUTPUT: samples    : the mixed audio
+ *****************************************************************************/
+typedef void (*SaturateKernel)(Sint16* samples, const int* accumulator,
+                               int count);
+
+/******************************************************************************
+ * The kernels for each level (see kernel.h). All of them give bit-identical
+ *    results. The KERNEL_AVX ones need AVX2, and are passed over for the
+ *    SSE2 ones on CPUs that only have AVX
+ *****************************************************************************/
+void mixScalar     (int* accumulator, const Sint16* samples, int count,
+                    int volume);
+void saturateScalar(Sint16* samples, const int* accumulator, int count);
+#ifdef KERNEL_X86
+void mixSSE        (int* accumulator, const Sint16* samples, int count,
+                    int volume);
+void saturateSSE   (Sint16* samples, const int* accumulator, int count);
+void mixAVX        (int* accumulator, const Sint16* samples, int count,
+                    int volume);
+void saturateAVX   (Sint16* samples, const int* accumulator, int count);
+#endif
+
+/******************************************************************************
+ * getMixKernel, getSaturateKernel: the kernel for a level, or for the best
+ *    level below it when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+MixKernel      getMixKernel(KernelLevel level);
+SaturateKernel getSaturateKernel(KernelLevel level);
+
+/******************************************************************************
+ * mix, saturate: run the best kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void mix(int* accumulator, const Sint16* samples, int count, int volume);
+void saturate(Sint16* samples, const int* accumulator, int count);
+
+#endif
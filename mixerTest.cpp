@@ -0,0 +1,149 @@
+/******************************************************************************
+ * mixerTest.cpp: checks that every mixing kernel matches the scalar one and
+ *    reports how many voices per millisecond each of them mixes, next to
+ *    one SDL_MixAudioFormat call per voice (how the AudioManager used to 
+ *    mix)
+ *****************************************************************************/
+#include "mixer.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+using namespace std;
+
+#define TEST_SAMPLES 8192 // one callback: 4096 stereo frames
+#define TEST_VOLUME  64
+
+void fill(vector<vector<Sint16> > &voices, int count);
+bool testMatches(KernelLevel level, const vector<vector<Sint16> > &voices);
+double testSpeed(KernelLevel level, const vector<vector<Sint16> > &voices);
+double testSpeedSDL(const vector<vector<Sint16> > &voices);
+
+int main()
+{
+   int counts[] = { 4, 16, 32 };
+   KernelLevel best = getKernelLevel();
+
+   srand(1);
+
+   cout << "best kernel: " << getKernelName(best) << endl;
+
+   cout << setw(8) << "voices" << setw(10) << "kernel"
+        << setw(14) << "voices/ms" << setw(10) << "matches\n";
+
+   bool pass = true;
+   for (int i = 0; i < 3; i++)
+   {
+      vector<vector<Sint16> > voices;
+      fill(voices, counts[i]);
+
+      cout << setw(8) << counts[i] << setw(10) << "SDL"
+           << setw(14) << fixed << setprecision(1)
+           << testSpeedSDL(voices) << endl;
+
+      for (int level = KERNEL_SCALAR; level <= best; level++)
+      {
+         bool matches = testMatches((KernelLevel)level, voices);
+         pass = pass && matches;
+
+         cout << setw(8)  << counts[i]
+              << setw(10) << getKernelName((KernelLevel)level)
+              << setw(14) << testSpeed((KernelLevel)level, voices)
+              << setw(9)  << (matches ? "yes" : "NO") << endl;
+      }
+   }
+
+   return pass ? 0 : 1;
+}
+
+/******************************************************************************
+ * fill: voices of loud noise, so that mixing several of them clips. The
+ *    length is odd so the kernels' leftovers are tested too
+ *****************************************************************************/
+void fill(vector<vector<Sint16> > &voices, int count)
+{
+   voices.resize(count);
+
+   for (int v = 0; v < count; v++)
+   {
+      voices[v].resize(TEST_SAMPLES - 3);
+      for (int i = 0; i < (int)voices[v].size(); i++)
+         voices[v][i] = (Sint16)(rand() % 65536 - 32768);
+   }
+}
+
+/******************************************************************************
+ * mixAll: mixes every voice with the kernels of a level
+ *****************************************************************************/
+void mixAll(KernelLevel level, const vector<vector<Sint16> > &voices,
+            vector<int> &accumulator, vector<Sint16> &out)
+{
+   MixKernel      mix      = getMixKernel(level);
+   SaturateKernel saturate = getSaturateKernel(level);
+   int            count    = voices[0].size();
+
+   fill(accumulator.begin(), accumulator.begin() + count, 0);
+   for (int v = 0; v < (int)voices.size(); v++)
+      mix(accumulator.data(), voices[v].data(), count, TEST_VOLUME);
+   saturate(out.data(), accumulator.data(), count);
+}
+
+/******************************************************************************
+ * testMatches: mixes the voices with a level's kernels and with the scalar
+ *    ones and compares the results bit for bit
+ *****************************************************************************/
+bool testMatches(KernelLevel level, const vector<vector<Sint16> > &voices)
+{
+   vector<int>    accumulator(TEST_SAMPLES);
+   vector<Sint16> out(TEST_SAMPLES), out2(TEST_SAMPLES);
+
+   mixAll(level, voices, accumulator, out);
+   mixAll(KERNEL_SCALAR, voices, accumulator, out2);
+
+   return out == out2;
+}
+
+/******************************************************************************
+ * testSpeed: voices mixed per millisecond by a level's kernels
+ *****************************************************************************/
+double testSpeed(KernelLevel level, const vector<vector<Sint16> > &voices)
+{
+   vector<int>    accumulator(TEST_SAMPLES);
+   vector<Sint16> out(TEST_SAMPLES);
+   int            runs = 20000 / voices.size();
+
+   clock_t start = clock();
+   for (int r = 0; r < runs; r++)
+      mixAll(level, voices, accumulator, out);
+   double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   return (double)voices.size() * runs / (seconds * 1e3);
+}
+
+/******************************************************************************
+ * testSpeedSDL: voices mixed per millisecond by SDL_MixAudioFormat, each 
+ *    call adding one voice into the 16 bit buffer and clamping it. 
+ *    SDL_MixAudio would do nothing here: it mixes in the format of audio 
+ *    device 1, and no device is open
+ *****************************************************************************/
+double testSpeedSDL(const vector<vector<Sint16> > &voices)
+{
+   vector<Sint16> out(TEST_SAMPLES);
+   int            bytes = voices[0].size() * sizeof(Sint16);
+   int            runs  = 20000 / voices.size();
+
+   clock_t start = clock();
+   for (int r = 0; r < runs; r++)
+   {
+      memset(out.data(), 0, bytes);
+      for (int v = 0; v < (int)voices.size(); v++)
+         SDL_MixAudioFormat((Uint8*)out.data(), 
+                            (const Uint8*)voices[v].data(), AUDIO_S16SYS,
+                            bytes, TEST_VOLUME);
+   }
+   double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   return (double)voices.size() * runs / (seconds * 1e3);
+}
@@ -0,0 +1,135 @@
+/******************************************************************************
+ * pool.cpp: implements the Pool class
+ *****************************************************************************/
+#include "pool.h"
+#include <assert.h>
+#include <iomanip>
+using namespace std;
+
+/******************************************************************************
+ * Every block is rounded up to this so any object can be placed in it
+ *****************************************************************************/
+#define POOL_ALIGNMENT 16
+
+/******************************************************************************
+ * Pool:
+ *    INPUT: name      : name shown by report
+ *           objectSize: size of the largest object that will be allocated
+ *           slabSize  : number of objects each slab holds
+ *****************************************************************************/
+Pool::Pool(const char* name, size_t objectSize, int slabSize)
+   : mName(name), mSlabSize(slabSize), mpFree(NULL), mLive(0), mPeak(0)
+{
+   assert(slabSize > 0);
+
+   if (objectSize < sizeof(void*))
+      objectSize = sizeof(void*);
+
+   mBlockSize = (objectSize + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT - 1);
+
+   pools().push_back(this);
+}
+
+/******************************************************************************
+ * ~Pool: releases every slab (all objects must have been released)
+ *****************************************************************************/
+Pool::~Pool()
+{
+   for (int i = 0; i < (int)mSlabs.size(); i++)
+   {
+      delete [] mSlabs[i];
+   }
+
+   vector<Pool*> &all = pools();
+   for (vector<Pool*>::iterator it = all.begin(); it != all.end(); it++)
+   {
+      if (*it == this)
+      {
+         all.erase(it);
+         break;
+      }
+   }
+}
+
+/******************************************************************************
+ * pools: every pool that currently exists (used by report)
+ *****************************************************************************/
+vector<Pool*> &Pool::pools()
+{
+   static vector<Pool*> all;
+   return all;
+}
+
+/******************************************************************************
+ * grow: allocates a new slab and adds its blocks to the free list
+ *****************************************************************************/
+void Pool::grow()
+{
+   char* pSlab = new char[mBlockSize * mSlabSize];
+   mSlabs.push_back(pSlab);
+
+   // Thread the blocks onto the free list, first block on top
+   for (int i = mSlabSize - 1; i >= 0; i--)
+   {
+      void* pBlock = pSlab + i * mBlockSize;
+      *(void**)pBlock = mpFree;
+      mpFree = pBlock;
+   }
+}
+
+/******************************************************************************
+ * allocate: takes a block from the pool
+ *    INPUT : size    : number of bytes needed (at most objectSize)
+ *    OUTPUT: <return>: the block
+ *****************************************************************************/
+void* Pool::allocate(size_t size)
+{
+   assert(size <= mBlockSize);
+
+   if (mpFree == NULL)
+      grow();
+
+   void* pBlock = mpFree;
+   mpFree = *(void**)pBlock;
+
+   if (++mLive > mPeak)
+      mPeak = mLive;
+
+   return pBlock;
+}
+
+/******************************************************************************
+ * release: returns a block to the pool
+ *    INPUT: pBlock: block returned by allocate (NULL is ignored)
+ *****************************************************************************/
+void Pool::release(void* pBlock)
+{
+   if (pBlock == NULL)
+      return;
+
+   assert(mLive > 0);
+
+   *(void**)pBlock = mpFree;
+   mpFree = pBlock;
+   mLive--;
+}
+
+/******************************************************************************
+ * report: writes the live, peak and capacity counts of every pool
+ *    INPUT: out: stream to write to
+ *****************************************************************************/
+void Pool::report(ostream &out)
+{
+   vector<Pool*> &all = pools();
+
+   out << setw(16) << left << "pool" << right
+       << setw(8) << "live" << setw(8) << "peak" << setw(10) << "capacity\n";
+
+   for (int i = 0; i < (int)all.size(); i++)
+   {
+      out << setw(16) << left << all[i]->getName() << right
+          << setw(8) << all[i]->getLive()
+          << setw(8) << all[i]->getPeak()
+          << setw(9) << all[i]->getCapacity() << endl;
+   }
+}
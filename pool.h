@@ -0,0 +1,86 @@
+/******************************************************************************
+ * pool.h: defines the Pool class, a slab allocator for objects of one type
+ *****************************************************************************/
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <vector>
+#include <ostream>
+
+/******************************************************************************
+ * Pool: hands out fixed-size blocks carved from large slabs. Freed blocks go
+ *    on a free list and are reused before a new slab is allocated, so once
+ *    a game reaches its peak number of objects no more heap allocations are
+ *    made. Slabs are only released when the pool is destroyed.
+ *
+ *    Classes use a pool by overriding operator new and operator delete:
+ *       static void* operator new(size_t size) { return sPool.allocate(size); }
+ *       static void  operator delete(void* p)  { sPool.release(p);            }
+ *****************************************************************************/
+class Pool
+{
+private:
+
+   const char*        mName;
+   size_t             mBlockSize;
+   int                mSlabSize;  // blocks per slab
+   std::vector<char*> mSlabs;
+   void*              mpFree;     // free blocks, linked through their first word
+   int                mLive;
+   int                mPeak;
+
+   /***************************************************************************
+    * grow: allocates a new slab and adds its blocks to the free list
+    **************************************************************************/
+   void grow();
+
+   /***************************************************************************
+    * pools: every pool that currently exists (used by report)
+    **************************************************************************/
+   static std::vector<Pool*> &pools();
+
+public:
+
+   /***************************************************************************
+    * Pool:
+    *    INPUT: name      : name shown by report
+    *           objectSize: size of the largest object that will be allocated
+    *           slabSize  : number of objects each slab holds
+    **************************************************************************/
+   Pool(const char* name, size_t objectSize, int slabSize = 64);
+
+   /***************************************************************************
+    * ~Pool: releases every slab (all objects must have been released)
+    **************************************************************************/
+   ~Pool();
+
+   /***************************************************************************
+    * allocate: takes a block from the pool
+    *    INPUT : size    : number of bytes needed (at most objectSize)
+    *    OUTPUT: <return>: the block
+    **************************************************************************/
+   void* allocate(size_t size);
+
+   /***************************************************************************
+    * release: returns a block to the pool
+    *    INPUT: pBlock: block returned by allocate (NULL is ignored)
+    **************************************************************************/
+   void release(void* pBlock);
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   const char* getName()     const { return mName;                        }
+   int         getLive()     const { return mLive;                        }
+   int         getPeak()     const { return mPeak;                        }
+   int         getCapacity() const { return (int)mSlabs.size() * mSlabSize; }
+
+   /***************************************************************************
+    * report: writes the live, peak and capacity counts of every pool
+    *    INPUT: out: stream to write to
+    **************************************************************************/
+   static void report(std::ostream &out);
+};
+
+#endif
@@ -0,0 +1,138 @@
+/******************************************************************************
+ * profiler.cpp: implements the Profiler
+ *****************************************************************************/
+#include "profiler.h"
+#include <fstream>
+using namespace std;
+
+bool   Profiler::sEnabled = false;
+Uint64 Profiler::sCurrent[PHASE_COUNT];
+Uint64 Profiler::sWindow[PROFILE_WINDOW][PHASE_COUNT];
+int    Profiler::sFrames = 0;
+
+/******************************************************************************
+ * csv: the file frames are streamed to (not open unless asked for)
+ *****************************************************************************/
+static ofstream &csv()
+{
+   static ofstream file;
+   return file;
+}
+
+/******************************************************************************
+ * toMicroseconds: converts performance counter ticks
+ *****************************************************************************/
+static double toMicroseconds(Uint64 ticks)
+{
+   return (double)ticks * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+/******************************************************************************
+ * endFrame: closes the current frame: records it in the window and streams
+ *    it to the CSV file
+ *****************************************************************************/
+void Profiler::endFrame()
+{
+   if (!sEnabled)
+      return;
+
+   Uint64* frame = sWindow[sFrames % PROFILE_WINDOW];
+
+   for (int p = 0; p < PHASE_COUNT; p++)
+   {
+      frame[p]    = sCurrent[p];
+      sCurrent[p] = 0;
+   }
+
+   if (csv().is_open())
+   {
+      csv() << sFrames;
+      for (int p = 0; p < PHASE_COUNT; p++)
+         csv() << ',' << toMicroseconds(frame[p]);
+      csv() << '\n';
+   }
+
+   sFrames++;
+}
+
+/******************************************************************************
+ * openCsv: streams one line per frame (microseconds per phase) to a file
+ *    from now on
+ *****************************************************************************/
+void Profiler::openCsv(const string &filename)
+{
+   csv().open(filename.c_str());
+   if (!csv())
+      throw string("Unable to write profile file ") + filename;
+
+   csv() << "index";
+   for (int p = 0; p < PHASE_COUNT; p++)
+      csv() << ',' << getPhaseName((ProfilePhase)p);
+   csv() << '\n';
+
+   sEnabled = true;
+}
+
+/******************************************************************************
+ * hasCsv: whether frames are being streamed to a CSV file
+ *****************************************************************************/
+bool Profiler::hasCsv()
+{
+   return csv().is_open();
+}
+
+/******************************************************************************
+ * getMin, getAvg, getMax: rolling statistics over the last PROFILE_WINDOW 
+ *    frames, in microseconds (0 before the first frame)
+ *****************************************************************************/
+double Profiler::getMin(ProfilePhase phase)
+{
+   int count = (sFrames < PROFILE_WINDOW) ? sFrames : PROFILE_WINDOW;
+   if (count == 0)
+      return 0;
+
+   Uint64 low = sWindow[0][phase];
+   for (int i = 1; i < count; i++)
+   {
+      if (sWindow[i][phase] < low)
+         low = sWindow[i][phase];
+   }
+   return toMicroseconds(low);
+}
+
+double Profiler::getAvg(ProfilePhase phase)
+{
+   int count = (sFrames < PROFILE_WINDOW) ? sFrames : PROFILE_WINDOW;
+   if (count == 0)
+      return 0;
+
+   Uint64 total = 0;
+   for (int i = 0; i < count; i++)
+      total += sWindow[i][phase];
+   return toMicroseconds(total) / count;
+}
+
+double Profiler::getMax(ProfilePhase phase)
+{
+   int count = (sFrames < PROFILE_WINDOW) ? sFrames : PROFILE_WINDOW;
+
+   Uint64 high = 0;
+   for (int i = 0; i < count; i++)
+   {
+      if (sWindow[i][phase] > high)
+         high = sWindow[i][phase];
+   }
+   return toMicroseconds(high);
+}
+
+/******************************************************************************
+ * getPhaseName: a printable name for a phase (also the CSV column)
+ *****************************************************************************/
+const char* Profiler::getPhaseName(ProfilePhase phase)
+{
+   static const char* NAMES[PHASE_COUNT] = 
+   {
+      "update", "collision", "draw", "numbers", "swap", "frame"
+   };
+   return NAMES[phase];
+}
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * profiler.h: defines the Profiler, which times each phase of a frame with
+ *    scoped timers and keeps rolling statistics of the last frames
+ *****************************************************************************/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+#include <string>
+
+/******************************************************************************
+ * Number of frames the rolling min/avg/max cover
+ *****************************************************************************/
+#define PROFILE_WINDOW 120
+
+/******************************************************************************
+ * ProfilePhase: the parts of a frame that are timed. A phase may be entered
+ *    several times per frame (one update per simulation step); its times 
+ *    add up. PHASE_FRAME is the whole frame
+ *****************************************************************************/
+enum ProfilePhase
+{
+   PHASE_UPDATE,    // entity update, spawning and deleting
+   PHASE_COLLISION, // broadphase, narrowphase and collision rules
+   PHASE_DRAW,      // sprites
+   PHASE_NUMBERS,   // drawNumber
+   PHASE_SWAP,      // SDL_GL_SwapWindow
+   PHASE_FRAME,
+   PHASE_COUNT
+};
+
+/******************************************************************************
+ * Profiler: collects the time spent in each phase during the current frame
+ *    and, at the end of each frame, adds it to the rolling window and to 
+ *    the CSV file (if one is open). While it is disabled a timer costs one
+ *    branch on a static flag
+ *****************************************************************************/
+class Profiler
+{
+public:
+
+   /***************************************************************************
+    * setEnabled: turns timing on or off. Opening a CSV file enables it
+    **************************************************************************/
+   static void setEnabled(bool enabled) { sEnabled = enabled; }
+   static bool isEnabled()              { return sEnabled;    }
+
+   /***************************************************************************
+    * add: adds time to a phase of the current frame
+    *    INPUT: phase: the phase
+    *           ticks: time in SDL performance counter ticks
+    **************************************************************************/
+   static void add(ProfilePhase phase, Uint64 ticks) 
+   {
+      sCurrent[phase] += ticks;
+   }
+
+   /***************************************************************************
+    * endFrame: closes the current frame: records it in the window and 
+    *    streams it to the CSV file
+    **************************************************************************/
+   static void endFrame();
+
+   /***************************************************************************
+    * openCsv: streams one line per frame (microseconds per phase) to a 
+    *    file from now on. Throws a string if the file can't be written
+    **************************************************************************/
+   static void openCsv(const std::string &filename);
+
+   /***************************************************************************
+    * hasCsv: whether frames are being streamed to a CSV file
+    **************************************************************************/
+   static bool hasCsv();
+
+   /***************************************************************************
+    * Rolling statistics over the last PROFILE_WINDOW frames, in microseconds
+    **************************************************************************/
+   static double getMin(ProfilePhase phase);
+   static double getAvg(ProfilePhase phase);
+   static double getMax(ProfilePhase phase);
+
+   static const char* getPhaseName(ProfilePhase phase);
+
+private:
+
+   static bool   sEnabled;
+   static Uint64 sCurrent[PHASE_COUNT];
+   static Uint64 sWindow[PROFILE_WINDOW][PHASE_COUNT];
+   static int    sFrames;  // frames recorded in total
+};
+
+/******************************************************************************
+ * ProfileScope: times the rest of the enclosing scope into a phase
+ *****************************************************************************/
+class ProfileScope
+{
+public:
+   ProfileScope(ProfilePhase phase) 
+      : mPhase(phase), 
+        mStart(Profiler::isEnabled() ? SDL_GetPerformanceCounter() : 0) { }
+
+   ~ProfileScope()
+   {
+      if (mStart != 0)
+         Profiler::add(mPhase, SDL_GetPerformanceCounter() - mStart);
+   }
+
+private:
+   ProfilePhase mPhase;
+   Uint64       mStart;
+};
+
+/******************************************************************************
+ * PROFILE: times the rest of the enclosing scope, e.g. 
+ *    PROFILE(PHASE_COLLISION);
+ *****************************************************************************/
+#define PROFILE_NAME(line) profileScope##line
+#define PROFILE_LINE(phase, line) ProfileScope PROFILE_NAME(line)(phase)
+#define PROFILE(phase) PROFILE_LINE(phase, __LINE__)
+
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+ * random.cpp: implements Random (xoshiro128** by Blackman and Vigna)
+ *****************************************************************************/
+#include "random.h"
+#include <assert.h>
+
+/******************************************************************************
+ * splitMix: the generator used to spread a seed over the state, so that 
+ *    similar seeds still give unrelated streams
+ *****************************************************************************/
+static uint64_t splitMix(uint64_t &x)
+{
+   uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+   return z ^ (z >> 31);
+}
+
+/******************************************************************************
+ * setSeed: restarts the generator
+ *    INPUT: seed  : any value (0 included)
+ *           stream: which of the seed's independent streams to use
+ *****************************************************************************/
+void Random::setSeed(uint64_t seed, int stream)
+{
+   assert(stream >= 0);
+
+   uint64_t a = splitMix(seed);
+   uint64_t b = splitMix(seed);
+
+   mState[0] = (uint32_t)a;
+   mState[1] = (uint32_t)(a >> 32);
+   mState[2] = (uint32_t)b;
+   mState[3] = (uint32_t)(b >> 32);
+
+   for (int i = 0; i < stream; i++)
+      jump();
+}
+
+/******************************************************************************
+ * jump: advances the state by 2^64 numbers
+ *****************************************************************************/
+void Random::jump()
+{
+   static const uint32_t JUMP[4] = 
+   { 
+      0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b 
+   };
+
+   uint32_t s[4] = {0, 0, 0, 0};
+
+   for (int i = 0; i < 4; i++)
+   {
+      for (int b = 0; b < 32; b++)
+      {
+         if (JUMP[i] & (1u << b))
+         {
+            s[0] ^= mState[0];
+            s[1] ^= mState[1];
+            s[2] ^= mState[2];
+            s[3] ^= mState[3];
+         }
+         next();
+      }
+   }
+
+   for (int i = 0; i < 4; i++)
+      mState[i] = s[i];
+}
+
+/******************************************************************************
+ * nextInt: a uniformly distributed integer between the given values 
+ *    (inclusive). Scales a 32-bit number into the range with a multiply and
+ *    rejects the few values that would make some results more likely
+ *    (Lemire's method)
+ *****************************************************************************/
+int Random::nextInt(int min, int max)
+{
+   assert(min <= max);
+
+   uint32_t range = (uint32_t)max - (uint32_t)min + 1;
+
+   // The full 32-bit range
+   if (range == 0)
+      return (int)next();
+
+   uint64_t product = (uint64_t)next() * range;
+   uint32_t low     = (uint32_t)product;
+
+   if (low < range)
+   {
+      uint32_t threshold = (0u - range) % range;
+      while (low < threshold)
+      {
+         product = (uint64_t)next() * range;
+         low     = (uint32_t)product;
+      }
+   }
+
+   int num = (int)((uint32_t)min + (uint32_t)(product >> 32));
+   assert(min <= num && num <= max);
+   return num;
+}
+
+/******************************************************************************
+ * fill: fills an array with uniformly distributed floats in [0, 1)
+ *    INPUT : count : number of floats
+ *    OUTPUT: values: the floats, in the order nextFloat would give them
+ *****************************************************************************/
+void Random::fill(float* values, int count)
+{
+   // Work on a local copy so the state stays in registers
+   Random local = *this;
+
+   for (int i = 0; i < count; i++)
+      values[i] = local.nextFloat();
+
+   *this = local;
+}
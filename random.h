@@ -0,0 +1,89 @@
+/******************************************************************************
+ * random.h: defines Random, a small seedable pseudo-random number generator
+ *    (xoshiro128**) with independent streams
+ *****************************************************************************/
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Random: a generator whose whole state is four words, so each simulation 
+ *    (and each worker thread inside it) can own one instead of sharing the
+ *    C library's. The same seed and stream always give the same numbers, on
+ *    every platform. Stream n starts 2^64 numbers after stream n-1, so 
+ *    streams made from one seed never overlap in practice: a worker can use
+ *    Random(seed, worker + 1) next to the simulation's Random(seed)
+ *****************************************************************************/
+class Random
+{
+private:
+
+   uint32_t mState[4];
+
+   /***************************************************************************
+    * jump: advances the state by 2^64 numbers (starts the next stream)
+    **************************************************************************/
+   void jump();
+
+   static uint32_t rotate(uint32_t x, int k) 
+   { 
+      return (x << k) | (x >> (32 - k)); 
+   }
+
+public:
+
+   Random(uint64_t seed = 0, int stream = 0) { setSeed(seed, stream); }
+
+   /***************************************************************************
+    * setSeed: restarts the generator
+    *    INPUT: seed  : any value (0 included)
+    *           stream: which of the seed's independent streams to use
+    **************************************************************************/
+   void setSeed(uint64_t seed, int stream = 0);
+
+   /***************************************************************************
+    * next: the next 32 random bits
+    **************************************************************************/
+   uint32_t next()
+   {
+      uint32_t result = rotate(mState[1] * 5, 7) * 9;
+      uint32_t t      = mState[1] << 9;
+
+      mState[2] ^= mState[0];
+      mState[3] ^= mState[1];
+      mState[1] ^= mState[2];
+      mState[0] ^= mState[3];
+      mState[2] ^= t;
+      mState[3]  = rotate(mState[3], 11);
+
+      return result;
+   }
+
+   /***************************************************************************
+    * nextInt: a uniformly distributed integer between the given values 
+    *    (inclusive), without the bias of next() % range
+    *    INPUT: min: minimum value
+    *           max: maximum value
+    **************************************************************************/
+   int nextInt(int min, int max);
+
+   /***************************************************************************
+    * nextFloat: a uniformly distributed float in [0, 1) or [min, max)
+    **************************************************************************/
+   float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+   float nextFloat(float min, float max)
+   {
+      return min + nextFloat() * (max - min);
+   }
+
+   /***************************************************************************
+    * fill: fills an array with uniformly distributed floats in [0, 1)
+    *    INPUT : count : number of floats
+    *    OUTPUT: values: the floats, in the order nextFloat would give them
+    **************************************************************************/
+   void fill(float* values, int count);
+};
+
+#endif
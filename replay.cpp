@@ -0,0 +1,188 @@
+/******************************************************************************
+ * replay.cpp: implements the Replay class
+ *****************************************************************************/
+#include "replay.h"
+#include <fstream>
+#include <limits.h>
+using namespace std;
+
+/******************************************************************************
+ * File format version, bumped whenever the format or the meaning of the 
+ *    input bits changes
+ *****************************************************************************/
+#define REPLAY_VERSION 1
+
+/******************************************************************************
+ * writeVarint: writes an unsigned number 7 bits at a time, low bits first;
+ *    the top bit of each byte says whether another byte follows
+ *****************************************************************************/
+static void writeVarint(ostream &out, unsigned value)
+{
+   while (value >= 0x80)
+   {
+      out.put((char)((value & 0x7F) | 0x80));
+      value >>= 7;
+   }
+   out.put((char)value);
+}
+
+/******************************************************************************
+ * readVarint: reads a number written by writeVarint
+ *****************************************************************************/
+static unsigned readVarint(istream &in)
+{
+   unsigned value = 0;
+
+   for (int shift = 0; shift < 35; shift += 7)
+   {
+      int byte = in.get();
+      if (byte == EOF)
+         throw string("Replay file is truncated");
+
+      value |= (unsigned)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+         return value;
+   }
+
+   throw string("Replay file is corrupt");
+}
+
+/******************************************************************************
+ * Replay:
+ *    INPUT: seed: random seed the session was started with
+ *****************************************************************************/
+Replay::Replay(unsigned seed)
+   : mSeed(seed), mTicks(0), mInput(0), mCursor(0), mNext(0)
+{
+}
+
+/******************************************************************************
+ * record: appends a tick
+ *    INPUT: input: the INPUT_ bits for the tick
+ *****************************************************************************/
+void Replay::record(unsigned input)
+{
+   if (input != mInput)
+   {
+      Change change;
+      change.tick  = mTicks;
+      change.input = input;
+      mChanges.push_back(change);
+
+      mInput = input;
+   }
+
+   mTicks++;
+}
+
+/******************************************************************************
+ * next: plays back the next tick (0 once the recording has run out)
+ *    OUTPUT: <return>: the INPUT_ bits for the tick
+ *****************************************************************************/
+unsigned Replay::next()
+{
+   if (isFinished())
+      return 0;
+
+   if (mNext < (int)mChanges.size() && mChanges[mNext].tick == mCursor)
+      mInput = mChanges[mNext++].input;
+
+   mCursor++;
+   return mInput;
+}
+
+/******************************************************************************
+ * save: writes the replay to a file
+ *    INPUT: filename: where to write it
+ *****************************************************************************/
+void Replay::save(const string &filename) const
+{
+   ofstream out(filename.c_str(), ios::binary);
+   if (!out)
+      throw string("Unable to write replay file ") + filename;
+
+   out.write("ASTR", 4);
+   writeVarint(out, REPLAY_VERSION);
+   writeVarint(out, mSeed);
+   writeVarint(out, (unsigned)mTicks);
+   writeVarint(out, (unsigned)mChanges.size());
+
+   int      tick  = 0;
+   unsigned input = 0;
+
+   for (int i = 0; i < (int)mChanges.size(); i++)
+   {
+      writeVarint(out, (unsigned)(mChanges[i].tick - tick));
+      writeVarint(out, mChanges[i].input ^ input);
+
+      tick  = mChanges[i].tick;
+      input = mChanges[i].input;
+   }
+
+   if (!out)
+      throw string("Unable to write replay file ") + filename;
+}
+
+/******************************************************************************
+ * load: reads a replay from a file and rewinds playback to the first tick
+ *    INPUT: filename: where to read it from
+ *****************************************************************************/
+void Replay::load(const string &filename)
+{
+   ifstream in(filename.c_str(), ios::binary);
+   if (!in)
+      throw string("Unable to read replay file ") + filename;
+
+   char magic[4];
+   in.read(magic, 4);
+   if (!in || string(magic, 4) != "ASTR")
+      throw string("Not a replay file: ") + filename;
+
+   if (readVarint(in) != REPLAY_VERSION)
+      throw string("Unsupported replay version: ") + filename;
+
+   mSeed = readVarint(in);
+
+   unsigned ticks = readVarint(in);
+   unsigned count = readVarint(in);
+
+   // Every change takes at least two bytes, so the rest of the file 
+   // bounds how many there can be
+   streampos here = in.tellg();
+   in.seekg(0, ios::end);
+   streamoff remaining = in.tellg() - here;
+   in.seekg(here);
+
+   if (ticks > (unsigned)INT_MAX || count > ticks || 
+       (streamoff)count * 2 > remaining)
+      throw string("Replay file is corrupt");
+
+   mTicks = (int)ticks;
+
+   mChanges.clear();
+   mChanges.reserve(count);
+
+   int      tick  = 0;
+   unsigned input = 0;
+
+   for (unsigned i = 0; i < count; i++)
+   {
+      // Changes fall on distinct ticks within the recording (only the 
+      // first can be on tick 0), or next() would never reach the rest
+      unsigned gap = readVarint(in);
+      if ((i > 0 && gap == 0) || gap >= (unsigned)(mTicks - tick))
+         throw string("Replay file is corrupt");
+
+      Change change;
+      change.tick  = tick + (int)gap;
+      change.input = input ^ readVarint(in);
+      mChanges.push_back(change);
+
+      tick  = change.tick;
+      input = change.input;
+   }
+
+   mInput  = 0;
+   mCursor = 0;
+   mNext   = 0;
+}
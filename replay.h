@@ -0,0 +1,84 @@
+/******************************************************************************
+ * replay.h: defines the Replay class, a recording of a game session (the 
+ *    random seed plus the input of every simulation tick) and its binary 
+ *    file format
+ *****************************************************************************/
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+#include <vector>
+
+/******************************************************************************
+ * Input bits: the state of the game's controls during one tick. MENU and 
+ *    PAUSE are key presses (they toggle), the others are keys held down
+ *****************************************************************************/
+#define INPUT_SPACE      0x01
+#define INPUT_LEFT       0x02
+#define INPUT_RIGHT      0x04
+#define INPUT_UP         0x08
+#define INPUT_DOWN       0x10
+#define INPUT_HYPERSPACE 0x20
+#define INPUT_MENU       0x40
+#define INPUT_PAUSE      0x80
+
+/******************************************************************************
+ * Replay: the input of every tick of a session, kept as the list of ticks 
+ *    where it changed. On disk (all numbers are LEB128 varints):
+ *
+ *       "ASTR" version seed ticks changes { gap xor }...
+ *
+ *    where each change happens gap ticks after the previous one (the first 
+ *    counts from tick 0) and the new input is the previous input xor'ed 
+ *    with xor (the input before the first change is 0)
+ *****************************************************************************/
+class Replay
+{
+private:
+
+   struct Change
+   {
+      int      tick;
+      unsigned input;
+   };
+
+   unsigned            mSeed;
+   int                 mTicks;   // ticks recorded
+   std::vector<Change> mChanges; // in tick order
+   unsigned            mInput;   // input as of the last recorded tick
+   int                 mCursor;  // playback: next tick
+   int                 mNext;    // playback: next change to apply
+
+public:
+
+   Replay(unsigned seed = 0);
+
+   /***************************************************************************
+    * record: appends a tick
+    *    INPUT: input: the INPUT_ bits for the tick
+    **************************************************************************/
+   void record(unsigned input);
+
+   /***************************************************************************
+    * next: plays back the next tick (0 once the recording has run out)
+    *    OUTPUT: <return>: the INPUT_ bits for the tick
+    **************************************************************************/
+   unsigned next();
+
+   /***************************************************************************
+    * save, load: write and read the file format above. Throw a string on 
+    *    failure. load also rewinds playback to the first tick
+    **************************************************************************/
+   void save(const std::string &filename) const;
+   void load(const std::string &filename);
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   unsigned getSeed()      const { return mSeed;                  }
+   int      getTickCount() const { return mTicks;                 }
+   int      getChanges()   const { return (int)mChanges.size();   }
+   bool     isFinished()   const { return mCursor >= mTicks;      }
+};
+
+#endif
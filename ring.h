@@ -0,0 +1,131 @@
+/******************************************************************************
+ * ring.h: defines the Ring, a fixed-size queue that one thread can push to
+ *    while another pops from it, without either ever taking a lock
+ *****************************************************************************/
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <assert.h>
+
+/******************************************************************************
+ * Ring: a single-producer, single-consumer queue of up to SIZE - 1 items.
+ *    Only one thread may push and only one may pop. The producer writes an
+ *    item and then publishes it by moving mHead on (release); the consumer
+ *    sees the new mHead (acquire) before it reads the item, so it never
+ *    reads one half written. Popping hands the slot back the same way
+ *    through mTail. SIZE must be a power of two
+ *****************************************************************************/
+template <class T, int SIZE>
+class Ring
+{
+private:
+
+   T                mItems[SIZE];
+   std::atomic<int> mHead;  // next slot to push to (written by the producer)
+   std::atomic<int> mTail;  // next slot to pop from (written by the consumer)
+
+public:
+
+   Ring() : mHead(0), mTail(0)
+   {
+      assert((SIZE & (SIZE - 1)) == 0);
+   }
+
+   /***************************************************************************
+    * push: adds an item (producer only)
+    *    INPUT : item    : what to add
+    *    OUTPUT: <return>: false if the ring was full and the item was not
+    *                      added
+    **************************************************************************/
+   bool push(const T &item)
+   {
+      int head = mHead.load(std::memory_order_relaxed);
+      int next = (head + 1) & (SIZE - 1);
+
+      if (next == mTail.load(std::memory_order_acquire))
+         return false;
+
+      mItems[head] = item;
+      mHead.store(next, std::memory_order_release);
+      return true;
+   }
+
+   /***************************************************************************
+    * pop: takes the oldest item (consumer only)
+    *    INPUT : item    : where to put it
+    *    OUTPUT: <return>: false if the ring was empty
+    **************************************************************************/
+   bool pop(T &item)
+   {
+      int tail = mTail.load(std::memory_order_relaxed);
+
+      if (tail == mHead.load(std::memory_order_acquire))
+         return false;
+
+      item = mItems[tail];
+      mTail.store((tail + 1) & (SIZE - 1), std::memory_order_release);
+      return true;
+   }
+
+   /***************************************************************************
+    * write: adds as many items as there is room for (producer only)
+    *    INPUT : items   : what to add
+    *            count   : how many
+    *    OUTPUT: <return>: how many were added
+    **************************************************************************/
+   int write(const T* items, int count)
+   {
+      int head = mHead.load(std::memory_order_relaxed);
+      int room = SIZE - 1 - 
+         ((head - mTail.load(std::memory_order_acquire)) & (SIZE - 1));
+
+      if (count > room)
+         count = room;
+
+      for (int i = 0; i < count; i++)
+         mItems[(head + i) & (SIZE - 1)] = items[i];
+
+      mHead.store((head + count) & (SIZE - 1), std::memory_order_release);
+      return count;
+   }
+
+   /***************************************************************************
+    * read: takes up to count of the oldest items (consumer only)
+    *    INPUT : items   : where to put them
+    *            count   : most to take
+    *    OUTPUT: <return>: how many were taken
+    **************************************************************************/
+   int read(T* items, int count)
+   {
+      int tail      = mTail.load(std::memory_order_relaxed);
+      int available = 
+         (mHead.load(std::memory_order_acquire) - tail) & (SIZE - 1);
+
+      if (count > available)
+         count = available;
+
+      for (int i = 0; i < count; i++)
+         items[i] = mItems[(tail + i) & (SIZE - 1)];
+
+      mTail.store((tail + count) & (SIZE - 1), std::memory_order_release);
+      return count;
+   }
+
+   /***************************************************************************
+    * getCount: the number of items waiting. Exact for the consumer; the
+    *    producer may see more than there are, never fewer
+    **************************************************************************/
+   int getCount() const
+   {
+      return (mHead.load(std::memory_order_acquire) - 
+              mTail.load(std::memory_order_acquire)) & (SIZE - 1);
+   }
+
+   /***************************************************************************
+    * getCapacity: the most items the ring can hold
+    **************************************************************************/
+   static int getCapacity() { return SIZE - 1; }
+};
+
+#endif
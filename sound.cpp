@@ -7,6 +7,7 @@
  *    independently
  *****************************************************************************/
 #include "sound.h"
+#include "mixer.h"
 using namespace std;
 
 /******************************************************************************
@@ -14,7 +15,7 @@ using namespace std;
  *****************************************************************************/
 
 /******************************************************************************
- * stop: stops the sound and disables looping (thread-safe)
+ * stop: stops the sound and disables looping
  *****************************************************************************/
 void PlaybackInfo::stop() 
 {
@@ -24,14 +25,13 @@ void PlaybackInfo::stop()
 
 /******************************************************************************
  * play: mixes the sound data into the audio stream 
- *    INPUT : audio:  audio stream to mix into
- *            length: maximum length of the sound data to mix
+ *    INPUT : audio:  accumulator to mix into (see mixer.h), one int per
+ *                    16 bit sample
+ *            length: maximum length of the sound data to mix (bytes)
  *            volume: volume of the sound
  *****************************************************************************/
-void PlaybackInfo::play(Uint8 *audio, int length, int volume)
+void PlaybackInfo::play(int *audio, int length, int volume)
 {
-   mIsPlaying = true;
-
    if (mLoop)
    {
       mpSound->loop(audio, length, volume, mPosition);   
@@ -39,8 +39,10 @@ void PlaybackInfo::play(Uint8 *audio, int length, int volume)
    else
    {
       mpSound->mix(audio, length, volume, mPosition);
-      mIsPlaying = (mPosition < mpSound->mLength);
    }
+
+   // A looping sound only ends if it is streamed and its file does
+   mIsPlaying = (mPosition < mpSound->mLength);
 }
 
 /******************************************************************************
@@ -57,37 +59,38 @@ Sound::Sound(string filename, SDL_AudioSpec *spec)
    mFilename = filename;
    mLength = 0;
    mpSamples = NULL;
+   mLimit = AUDIO_SOUND_LIMIT;
    load(filename, spec);
 }
 
 /******************************************************************************
- * ~Sound: clean-up
- *****************************************************************************/
-Sound::~Sound()
+ * Sound: for sounds that bring in their own samples (see StreamingSound)
+ *    INPUT: filename: name of the file
+ *****************************************************************************/ 
+Sound::Sound(string filename)
 {
-   delete [] mpSamples;
+   mFilename = filename;
+   mLength = 0;
+   mpSamples = NULL;
+   mLimit = AUDIO_SOUND_LIMIT;
 }
 
 /******************************************************************************
- * getPlaybackInfo: retrieves a structure containing playback info for the 
- *    Sound file. It mostly keeps track of current position, etc. without 
- *    copying the raw sound data.
- *    INPUT : loop    : whether to loop the sound or play it once through
- *    OUTPUT: <return>: pointer to the new PlaybackInfo instance
+ * ~Sound: clean-up
  *****************************************************************************/
-PlaybackInfo* Sound::getPlaybackInfo(bool loop) const
-{ 
-   return new PlaybackInfo(this, loop); 
+Sound::~Sound()
+{
+   delete [] mpSamples;
 }
 
 /******************************************************************************
  * mix: mixes the sound data into the audio stream until the end of the 
  *    sound data
- *    INPUT : audio:  audio stream to mix into
- *            length: maximum length of the sound data to mix
+ *    INPUT : audio:  accumulator to mix into (see mixer.h)
+ *            length: maximum length of the sound data to mix (bytes)
  *            volume: volume of the sound
  *****************************************************************************/
-void Sound::mix(Uint8 *audio, int length, int volume, int &position) const
+void Sound::mix(int *audio, int length, int volume, int &position) const
 {
    assert(volume  > 0 && volume < SDL_MIX_MAXVOLUME);
    assert(length >= 0 && audio != NULL);
@@ -102,18 +105,18 @@ void Sound::mix(Uint8 *audio, int length, int volume, int &position) const
    }
 
    // Mix audio and update audio status
-   SDL_MixAudio(audio, pSample, length, volume); 
+   ::mix(audio, (const Sint16*)pSample, length / 2, volume); 
    position += length;   
 }
 
 /******************************************************************************
  * loop: mixes the sound data into the audio stream, filling the buffer with
  *    looping sound data
- *    INPUT : audio:  audio stream to mix into
- *            length: absolute length of the sound data to mix
+ *    INPUT : audio:  accumulator to mix into (see mixer.h)
+ *            length: absolute length of the sound data to mix (bytes)
  *            volume: volume of the sound
  *****************************************************************************/
-void Sound::loop(Uint8 *audio, int length, int volume, int &position) const
+void Sound::loop(int *audio, int length, int volume, int &position) const
 {
    assert(volume  > 0 && volume < SDL_MIX_MAXVOLUME);
    assert(length >= 0 && audio != NULL);
@@ -139,7 +142,8 @@ void Sound::loop(Uint8 *audio, int length, int volume, int &position) const
       }
 
       // Mix the current section of audio data
-      SDL_MixAudio(audio + nMixed, pSample, writeLength, volume);
+      ::mix(audio + nMixed / 2, (const Sint16*)pSample, writeLength / 2, 
+            volume);
       nMixed += writeLength;
       assert(nMixed <= length);
    }
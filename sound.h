@@ -7,6 +7,8 @@
 #include <assert.h>
 using std::string;
 
+#define AUDIO_SOUND_LIMIT 4 // default voices one sound may use at once
+
 /***************************************************************************
  * Forward declarations
  **************************************************************************/
@@ -15,27 +17,35 @@ class PlaybackInfo;
 
 /***************************************************************************
  * PlaybackInfo: contains necessary data for playing an audio file. This 
- *    prevents needing complete copies of the Sound class
+ *    prevents needing complete copies of the Sound class. The AudioManager
+ *    keeps a fixed array of them, one per voice
  **************************************************************************/
 class PlaybackInfo
 {
 private:
 
-   friend class Sound; // Allow Sound to create instances of this class
-
    int          mPosition;
    bool         mIsPlaying;
    bool         mLoop;
    const Sound *mpSound;
 
+public:
+
+   PlaybackInfo() 
+      : mPosition(0), mIsPlaying(false), mLoop(false), mpSound(NULL) {  }
+
    /***************************************************************************
-    * PlaybackInfo: special constructor, only Sound will be making instances
-    *    of this class
+    * start: starts playing a sound from the beginning
+    *    INPUT: pSound: the sound to play
+    *           loop  : whether to loop the sound or play it once through
     **************************************************************************/
-   PlaybackInfo(const Sound * pSound, bool loop) 
-      : mPosition(0), mpSound(pSound), mIsPlaying(false), mLoop(loop) {  }
-
-public:
+   void start(const Sound* pSound, bool loop)
+   {
+      mpSound   = pSound;
+      mLoop     = loop;
+      mPosition = 0;
+      mIsPlaying = true;
+   }
 
    /***************************************************************************
     * isPlaying: determines whether or not the current sound is playing
@@ -44,26 +54,23 @@ public:
    bool isPlaying() const { return mIsPlaying; }
 
    /***************************************************************************
-    * play: mixes the sound data into the audio stream 
-    *    INPUT : audio:  audio stream to mix into
-    *            length: maximum length of the sound data to mix
-    *            volume: volume of the sound
+    * getSound: the sound being played
     **************************************************************************/
-   void play(Uint8 *audio, int length, int volume);
+   const Sound* getSound() const { return mpSound; }
 
    /***************************************************************************
-    * stop: stops the sound and disables looping (thread-safe)
+    * play: mixes the sound data into the audio stream 
+    *    INPUT : audio:  accumulator to mix into (see mixer.h), one int per
+    *                    16 bit sample
+    *            length: maximum length of the sound data to mix (bytes)
+    *            volume: volume of the sound
     **************************************************************************/
-   void stop();
+   void play(int *audio, int length, int volume);
 
    /***************************************************************************
-    * operator==: checks if the Sound instances of two PlaybackInfo's are the
-    *    same. The right-hand side is generally a pointer returned by an
-    *    iterator, so this is an overload for convenience
-    *    INPUT : rhs     : pointer to a PlaybackInfo to compare to
-    *    OUTPUT: <return>: true if both point to the same sound
+    * stop: stops the sound and disables looping
     **************************************************************************/
-   bool operator==(const PlaybackInfo *rhs) { return mpSound == rhs->mpSound; }
+   void stop();
 };
 
 /***************************************************************************
@@ -78,6 +85,7 @@ public:
    string mFilename;
    Uint32 mLength;
    Uint8* mpSamples;          // Raw PCM sample data
+   int    mLimit;             // most voices that may play it at once
 
    /***************************************************************************
     * load: loads the specified audio file and converts it to the specified
@@ -92,20 +100,27 @@ public:
    /***************************************************************************
     * mix: mixes the sound data into the audio stream until the end of the 
     *    sound data
-    *    INPUT : audio:  audio stream to mix into
-    *            length: maximum length of the sound data to mix
+    *    INPUT : audio:  accumulator to mix into (see mixer.h)
+    *            length: maximum length of the sound data to mix (bytes)
     *            volume: volume of the sound
     **************************************************************************/
-   void mix(Uint8 *audio, int length, int volume, int &position) const;
+   virtual void mix(int *audio, int length, int volume, int &position) const;
 
    /***************************************************************************
     * loop: mixes the sound data into the audio stream, filling the buffer with
     *    looping sound data
-    *    INPUT : audio:  audio stream to mix into
-    *            length: absolute length of the sound data to mix
+    *    INPUT : audio:  accumulator to mix into (see mixer.h)
+    *            length: absolute length of the sound data to mix (bytes)
     *            volume: volume of the sound
     **************************************************************************/
-   void loop(Uint8 *audio, int length, int volume, int &position) const;
+   virtual void loop(int *audio, int length, int volume, int &position) 
+      const;
+
+   /***************************************************************************
+    * Sound: for sounds that bring in their own samples (see StreamingSound)
+    *    INPUT: filename: name of the file
+    **************************************************************************/ 
+   Sound(string filename);
 
 public:
 
@@ -119,21 +134,18 @@ public:
    /***************************************************************************
    * ~Sound: clean-up
    **************************************************************************/
-   ~Sound();
+   virtual ~Sound();
 
    /***************************************************************************
     * Getters
     **************************************************************************/ 
    string getFilename() const { return mFilename;  }
+   int    getLimit()    const { return mLimit;     }
 
    /***************************************************************************
-    * getPlaybackInfo: retrieves a structure containing playback info for the 
-    *    Sound file. It mostly keeps track of current position, etc. without 
-    *    copying the raw sound data.
-    *    INPUT : loop    : whether to loop the sound or play it once through
-    *    OUTPUT: <return>: pointer to the new PlaybackInfo instance
-    **************************************************************************/
-   PlaybackInfo* getPlaybackInfo(bool loop) const;
+    * Setters
+    **************************************************************************/ 
+   void setLimit(int limit) { assert(limit > 0); mLimit = limit; }
 };
 
 #endif
\ No newline at end of file
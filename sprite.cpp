@@ -1,103 +1,57 @@
 #include "sprite.h"
+#include "trig.h"
 #include <math.h>
 using namespace std;
 
-/************************************************************************
- * Effect:
- *    INPUT: pSprite : pointer to the sprite to animate
- *           duration: how long the animation should last in ms
- ***********************************************************************/
-Effect::Effect(Sprite* pSprite, float duration)
-   : mDuration(duration), mTimeElapsed(0), mpSprite(pSprite),
-     mIsFinished(false)
-{
-}
-
 /******************************************************************************
- * SizeEffect:
- *    INPUT: pSprite : pointer to the sprite to animate
- *           width   : new width of the sprite
- *           height  : new height of the sprite
- *           duration: how long the animation should last in seconds 
+ * addQuad: adds a rotated, textured rectangle to the sprite batch
+ *    INPUT: pGraphics    : where to draw
+ *           pTexture     : the texture
+ *           x, y         : center point
+ *           width, height: size (in OpenGL coordinates)
+ *           rot          : rotation
+ *           uMin, uMax   : texture coordinates of the left and right edges
+ *           alpha        : opacity, 0 to 1
  *****************************************************************************/
-SizeEffect::SizeEffect(
-      Sprite* pSprite, float width, float height, float duration = 0)
-   : Effect(pSprite, duration)
+static void addQuad(Graphics* pGraphics, const Texture* pTexture, 
+                    float x, float y, float width, float height, float rot,
+                    float uMin, float uMax, float alpha = 1)
 {
-   mWidth     = pSprite->getWidth();
-   mHeight    = pSprite->getHeight();
-   mNewWidth  = width;
-   mNewHeight = height;
-}
+   // Corners of the box around the center point (px, py), rotated here
+   // so that sprites with different rotations can share a draw call
+   float s, c;
+   sinCos(rot, s, c);
 
-/******************************************************************************
-* operator+=: advances the animation
-*    INPUT: dt: the amount of time that has passed, in seconds
-*****************************************************************************/
-void SizeEffect::operator+=(float dt) 
-{
-   float width  = mWidth;
-   float height = mHeight;
+   float wx =  width  / 2 * c; // half width  along the rotated x axis
+   float wy =  width  / 2 * s;
+   float hx = -height / 2 * s; // half height along the rotated y axis
+   float hy =  height / 2 * c;
 
-   if (!mIsFinished)
+   float corners[8] =
    {
-      float progress = getProgress();
-      width  += (mNewWidth  - mWidth)  * progress;
-      height += (mNewHeight - mHeight) * progress;
-      mIsFinished = mTimeElapsed >= mDuration;
-   }
-
-   mpSprite->setHeight(height);
-   mpSprite->setWidth(width);
+      x - wx - hx, y - wy - hy,
+      x + wx - hx, y + wy - hy,
+      x + wx + hx, y + wy + hy,
+      x - wx + hx, y - wy + hy
+   };
 
-   mTimeElapsed += dt;
+   // Images are stored top row first
+   pGraphics->getSprites()->add(pTexture->getId(), corners, uMin, uMax,
+      pTexture->getV(0), pTexture->getV(1), alpha);
 }
 
-/******************************************************************************
- * BlinkEffect:
- *    INPUT: pSprite  : pointer to the sprite to animate
- *           blinkRate: how fast the sprite should blink
- *           duration : how long the animation should last in seconds 
- *****************************************************************************/
-BlinkEffect::BlinkEffect(Sprite* pSprite, float blinkRate, float duration)
-   : Effect(pSprite, duration), mBlinkRate(blinkRate), mLastBlink(0)
-{
-}
-
-/******************************************************************************
- * operator+=: advances the animation
- *    INPUT: dt: the amount of time that has passed, in seconds
- *****************************************************************************/
- void BlinkEffect::operator+=(float dt)
- {
-    if (!mIsFinished)
-    {
-       if (mTimeElapsed - mBlinkRate > mLastBlink)
-       {
-         mLastBlink = mTimeElapsed;
-         mpSprite->setVisible(!mpSprite->isVisible());
-       }
-       mIsFinished = mTimeElapsed >= mDuration;
-    }
-    
-    if (mIsFinished) // Not an "else" because this could have just been set
-    {
-       mpSprite->setVisible(true);
-    }
-    mTimeElapsed += dt;
- }
-
 /******************************************************************************
  * Sprite:
  *    INPUT: graphics: reference to the graphics object
  *           texture : filename of the texture to use
  *****************************************************************************/
-Sprite::Sprite(Graphics* pGraphics, string texture)
+Sprite::Sprite(Graphics* pGraphics, const string &texture)
 {
-   mpTexture = pGraphics->loadTexture(texture);
-   mWidth    = mpTexture->getHeight();
-   mHeight   = mpTexture->getHeight();
-   mVisible  = true;
+   mpGraphics = pGraphics;
+   mpTexture  = pGraphics->loadTexture(texture);
+   mWidth     = mpTexture->getHeight();
+   mHeight    = mpTexture->getHeight();
+   mVisible   = true;
 }
 
 /******************************************************************************
@@ -107,71 +61,20 @@ Sprite::Sprite(Graphics* pGraphics, string texture)
  *           width   : width  of the sprite (in OpenGL coordinates)
  *           height  : height of the sprite (in OpenGL coordinates)
  *****************************************************************************/
-Sprite::Sprite(Graphics* pGraphics, string texture, int width, int height)
-{
-   mpTexture = pGraphics->loadTexture(texture);
-   mWidth    = width;
-   mHeight   = height;
-   mVisible  = true;
-}
-
-/***************************************************************************
- * ~Sprite:
- **************************************************************************/
-Sprite::~Sprite()
-{
-   for (list<Effect*>::iterator it = mEffects.begin();
-      it != mEffects.end(); )
-   {
-      delete (*it); // ... yeah, delete it
-   }
-}
-
-/***************************************************************************
- * changeSize: changes the size of the sprite
- *    INPUT: width   : new width of the sprite
- *           height  : new height of the sprite
- *           duration: amount of time to animate (in seconds)
- **************************************************************************/
-void Sprite::changeSize(float width, float height, float duration)
-{
-   mEffects.push_back(new SizeEffect(this, width, height, duration));
-}
-
-/***************************************************************************
- * blink: causes the entity to blink
- *    INPUT: interval: time between blinks
- *           duration: amount of time to animate (in seconds)
- **************************************************************************/
-void Sprite::blink(float interval, float duration)
-{
-   mEffects.push_back(new BlinkEffect(this, interval, duration));
-}
-
-/******************************************************************************
- * effects: process all the effects for the sprite
- *    INPUT: dt: amount of time that as elapsed
- *****************************************************************************/
-void Sprite::effects(float dt)
+Sprite::Sprite(Graphics* pGraphics, const string &texture, 
+      int width, int height)
 {
-   for (list<Effect*>::iterator it = mEffects.begin();
-      it != mEffects.end(); )
-   {
-      if ((*it)->isFinished())
-      {
-         it = mEffects.erase(it);
-      }
-      else
-      {
-         (*(*it)) += dt;
-         it++;
-      }
-   }
+   mpGraphics = pGraphics;
+   mpTexture  = pGraphics->loadTexture(texture);
+   mWidth     = width;
+   mHeight    = height;
+   mVisible   = true;
 }
 
 /******************************************************************************
  * render: draws the sprite with the given center, rotation, and texture
- *    coordinates (which determines which part of the image is displayed)
+ *    coordinates (which determines which part of the image is displayed).
+ *    The quad goes into the graphics' sprite batch
  *    INPUT: x   : center point x position
  *           y   : center point y position
  *           rot : the sprite's rotation
@@ -180,43 +83,11 @@ void Sprite::effects(float dt)
  *****************************************************************************/
 void Sprite::render(float x, float y, float rot, float tmin, float tmax, float dt) 
 {
-   effects(dt); // Run the effects before rendering
-
-   if (!mVisible)
+   if (!mVisible || !mpTexture->isUploaded())
       return;
 
-   // Set box around center point (px, py)
-   float xmin = x -  mWidth / 2;
-   float xmax = x +  mWidth / 2;
-   float ymin = y - mHeight / 2;
-   float ymax = y + mHeight / 2;
-
-   glPushMatrix();
-
-   glTranslatef(x, y, 0);
-   glRotatef(rot, 0.0, 0.0, 1.0);
-   glTranslatef(-x, -y, 0);
-
-   // Bind textures and draw a textured rectangle
-   glBindTexture(GL_TEXTURE_2D, mpTexture->getId());
-
-   glBegin(GL_QUADS);
-
-   glTexCoord2f(tmin,    1);
-   glVertex2f(  xmin, ymin);
- 
-   glTexCoord2f(tmax,    1);
-   glVertex2f(  xmax, ymin);
- 
-   glTexCoord2f(tmax,    0);
-   glVertex2f(  xmax, ymax);
- 
-   glTexCoord2f(tmin,    0);
-   glVertex2f(  xmin, ymax);
-
-   glEnd();
-
-   glPopMatrix();
+   addQuad(mpGraphics, mpTexture, x, y, mWidth, mHeight, rot, 
+           mpTexture->getU(tmin), mpTexture->getU(tmax));
 }
 
 /******************************************************************************
@@ -232,47 +103,54 @@ void Sprite::draw(float x, float y, float r, float dt)
 }
 
 /******************************************************************************
- * AnimatedSprite:
- *    INPUT: pGraphics: reference to the graphics object
- *           texture  : filename of the texture to use
+ * SpriteDef:
+ *    INPUT: pTexture : the sheet
+ *           frameRate: how many draws each frame stays up for
  *****************************************************************************/
-AnimatedSprite::AnimatedSprite(
-     Graphics* pGraphics, string texture, float frameRate)
-   : Sprite(pGraphics, texture), mTimeElapsed(0), mFrameRate(frameRate)
+SpriteDef::SpriteDef(const Texture* pTexture, float frameRate)
+   : mpTexture(pTexture), mFrameRate(frameRate)
 {
-   mFrameCount = mpTexture->getWidth() / mpTexture->getHeight() ;
+   mFrameCount = pTexture->getWidth() / pTexture->getHeight();
+
+   float step = 1.0 / (float)mFrameCount;
+   for (int i = 0; i <= mFrameCount; i++)
+      mFrameU.push_back(pTexture->getU(step * i));
 }
 
 /******************************************************************************
- * AnimatedSprite:
- *    INPUT: graphics: reference to the graphics object
- *           texture : filename of the texture to use
- *           width   : width  of the sprite (in OpenGL coordinates)
- *           height  : height of the sprite (in OpenGL coordinates)
+ * draw: draws one frame
+ *    INPUT: pGraphics    : where to draw
+ *           x, y         : center point
+ *           width, height: size (in OpenGL coordinates)
+ *           rot          : rotation
+ *           frame        : which frame
+ *           alpha        : opacity, 0 to 1
  *****************************************************************************/
-AnimatedSprite::AnimatedSprite(
-     Graphics* pGraphics, string texture, int width, int height, 
-     float frameRate)
-   : Sprite(pGraphics, texture, width, height), mTimeElapsed(0), 
-     mFrameRate(frameRate)
+void SpriteDef::draw(Graphics* pGraphics, float x, float y, float width, 
+                     float height, float rot, int frame, float alpha) const
 {
-   mFrameCount = mpTexture->getWidth() / mpTexture->getHeight() ;
+   if (!mpTexture->isUploaded())
+      return;
+
+   addQuad(pGraphics, mpTexture, x, y, width, height, rot, 
+           mFrameU[frame], mFrameU[frame + 1], alpha);
 }
 
 /******************************************************************************
- * draw: draws the sprite to the screen with the given position and rotation
- *    INPUT: x  : center point x position
- *           y  : center point y position
- *           rot: the sprite's rotation
- *           dt : time elapsed since last draw (in milliseconds)
+ * draw: draws the current frame and moves the animation on
+ *    INPUT: pGraphics: where to draw
+ *           x, y     : center point
+ *           rot      : rotation
+ *           dt       : time elapsed since last draw
  *****************************************************************************/
-void AnimatedSprite::draw(float x, float y, float r, float dt)
+void SpriteInstance::draw(Graphics* pGraphics, float x, float y, float rot, 
+                          float dt)
 {
-   mTimeElapsed += ceil(dt);
-   float temp = mTimeElapsed / mFrameRate;
-   int frame = (int)(mTimeElapsed / mFrameRate) % mFrameCount;
-   float step = 1.0 / (float)mFrameCount;
-   render(x, y, r, step * frame, step * (frame + 1), dt);
+   elapsed += ceil(dt);
+   int frame = (int)(elapsed / pDef->getFrameRate()) % pDef->getFrameCount();
+
+   if (visible && alpha > 0)
+      pDef->draw(pGraphics, x, y, width, height, rot + spin, frame, alpha);
 }
 
 /******************************************************************************
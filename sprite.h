@@ -1,6 +1,7 @@
 /******************************************************************************
  * sprite.h: defines the Sprite class and derivatives which are used for 
- *    animating 2D textures in OpenGL. Also includes the Effect classes
+ *    animating 2D textures in OpenGL and the shared SpriteDef entities draw 
+ *    with
  *****************************************************************************/
 #ifndef SPRITE_H
 #define SPRITE_H
@@ -8,111 +9,10 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 #include <string>
-#include <list>
+#include <vector>
 #include "graphics.h"
 #include "texture.h"
 
-/******************************************************************************
- * Forward declarations
- *****************************************************************************/
-class Sprite;
-
-/******************************************************************************
- * Effect: animates a sprite with an effect
- *****************************************************************************/
-class Effect
-{
-protected:
-
-   float   mDuration;
-   float   mTimeElapsed;
-   bool    mIsFinished;
-   Sprite* mpSprite;
-
-   /***************************************************************************
-   * progress: percentage representing stage of the animation
-   *    OUTPUT: <return> returns the percent completion
-   **************************************************************************/
-   float getProgress() const { return mTimeElapsed / mDuration; }
-
-public:
-
-   /***************************************************************************
-   * Effect:
-   *    INPUT: pSprite : pointer to the sprite to animate
-   *           duration: how long the animation should last in milliseconds 
-   **************************************************************************/
-   Effect(Sprite* pSprite, float duration = 1);
-
-   /***************************************************************************
-   * isFinished: returns true if the animation has finished
-   **************************************************************************/
-   bool isFinished() const { return mIsFinished; }
-
-   /***************************************************************************
-   * operator+=: advances the animation
-   *    INPUT: dt: the amount of time that has passed, in seconds
-   **************************************************************************/
-   virtual void operator+=(float dt) = 0;
-};
-
-/******************************************************************************
- * SizeEffect: animates the sprite changing size
- *****************************************************************************/
-class SizeEffect : public Effect
-{
-private:
-
-   float mWidth;
-   float mHeight;
-   float mNewWidth;
-   float mNewHeight;
-
-public:
-
-   /***************************************************************************
-   * SizeEffect:
-   *    INPUT: pSprite : pointer to the sprite to animate
-   *           width   : new width of the sprite
-   *           height  : new height of the sprite
-   *           duration: how long the animation should last in seconds 
-   **************************************************************************/
-   SizeEffect(Sprite* pSprite, float width, float height, float duration);
-
-   /***************************************************************************
-   * operator+=: advances the animation
-   *    INPUT: dt: the amount of time that has passed, in seconds
-   **************************************************************************/
-   virtual void operator+=(float dt);
-};
-
-/******************************************************************************
- * BlinkEffect: animates the sprite blinking
- *****************************************************************************/
-class BlinkEffect : public Effect
-{
-private:
-
-   float mBlinkRate;
-   float mLastBlink;
-
-public:
-
-   /***************************************************************************
-   * BlinkEffect:
-   *    INPUT: pSprite  : pointer to the sprite to animate
-   *           blinkRate: how fast the sprite should blink
-   *           duration : how long the animation should last in seconds 
-   **************************************************************************/
-   BlinkEffect(Sprite* pSprite, float blinkRate, float duration);
-
-   /***************************************************************************
-   * operator+=: advances the animation
-   *    INPUT: dt: the amount of time that has passed, in seconds
-   **************************************************************************/
-   virtual void operator+=(float dt);
-};
-
 /******************************************************************************
  * Sprite: draws 2D textures on the screen using OpenGL
  *****************************************************************************/
@@ -124,12 +24,12 @@ protected:
    int            mWidth;
    bool           mVisible;
    const Texture* mpTexture;
-
-   std::list<Effect*> mEffects;
+   Graphics*      mpGraphics;
 
    /***************************************************************************
     * render: draws the sprite with the given center, rotation, and texture
-    *    coordinates (which determines which part of the image is displayed)
+    *    coordinates (which determines which part of the image is displayed).
+    *    The quad goes into the graphics' sprite batch
     *    INPUT: x   : center point x position
     *           y   : center point y position
     *           rot : the sprite's rotation
@@ -139,12 +39,6 @@ protected:
     **************************************************************************/
    void render(float x, float y, float rot, float tmin, float tmax, float dt);
 
-   /***************************************************************************
-    * effects: process all the effects for the sprite
-    *    INPUT: dt: amount of time that as elapsed
-    **************************************************************************/
-   void effects(float dt);
-
 public:
 
    /***************************************************************************
@@ -152,7 +46,7 @@ public:
     *    INPUT: pGraphics: reference to the graphics object
     *           texture  : filename of the texture to use
     **************************************************************************/
-   Sprite(Graphics* pGraphics, std::string texture);
+   Sprite(Graphics* pGraphics, const std::string &texture);
 
    /***************************************************************************
     * Sprite:
@@ -161,12 +55,13 @@ public:
     *           width    : width  of the sprite (in OpenGL coordinates)
     *           height   : height of the sprite (in OpenGL coordinates)
     **************************************************************************/
-   Sprite(Graphics* pGraphics, std::string texture, int width, int height);
+   Sprite(Graphics* pGraphics, const std::string &texture, 
+      int width, int height);
 
    /***************************************************************************
     * ~Sprite:
     **************************************************************************/
-   virtual ~Sprite();
+   virtual ~Sprite() { }
 
    /***************************************************************************
     * Getters
@@ -174,7 +69,6 @@ public:
    int getWidth()    const { return mWidth;   }
    int getHeight()   const { return mHeight;  }
    int isVisible()   const { return mVisible; }
-   bool hasEffects() const { return mEffects.size() > 0; }
 
    /***************************************************************************
     * Setters
@@ -192,65 +86,81 @@ public:
     **************************************************************************/
    virtual void draw(float x, float y, float rot = 0.0, float dt = 0.0);
 
-   /***************************************************************************
-    * changeSize: changes the size of the sprite
-    *    INPUT: width   : new width of the sprite
-    *           height  : new height of the sprite
-    *           duration: amount of time to animate (in seconds)
-    **************************************************************************/
-   void changeSize(float width, float height, float duration);
-
-   /***************************************************************************
-    * blink: causes the entity to blink
-    *    INPUT: interval: time between blinks
-    *           duration: amount of time to animate (in seconds)
-    **************************************************************************/
-   void blink(float interval, float duration);
 };
 
 /******************************************************************************
- * Sprite: draws animated 2D textures on the screen using OpenGL
+ * SpriteDef: what every sprite drawn from one sheet shares: the texture, the
+ *    texture coordinates of its frames (laid out left to right, each as wide
+ *    as the sheet is tall) and the frame rate. Never changes once made; 
+ *    Graphics::loadSpriteDef keeps one per sheet
  *****************************************************************************/
-class AnimatedSprite : public Sprite
+class SpriteDef
 {
-protected:
+private:
 
-   int   mFrameRate;
-   int   mFrameCount;
-   long  mTimeElapsed;
+   const Texture*     mpTexture;
+   int                mFrameCount;
+   float              mFrameRate;  // draws per frame
+   std::vector<float> mFrameU;     // left edge of each frame, then the right
 
 public:
 
    /***************************************************************************
-    * AnimatedSprite:
-    *    INPUT: graphics: reference to the graphics object
-    *           texture : filename of the texture to use
+    * SpriteDef:
+    *    INPUT: pTexture : the sheet
+    *           frameRate: how many draws each frame stays up for
     **************************************************************************/
-   AnimatedSprite(
-      Graphics* pGraphic, std::string texture, float frameRate = 10);
+   SpriteDef(const Texture* pTexture, float frameRate = 10);
 
    /***************************************************************************
-    * AnimatedSprite:
-    *    INPUT: graphics: reference to the graphics object
-    *           texture : filename of the texture to use
-    *           width   : width  of the sprite (in OpenGL coordinates)
-    *           height  : height of the sprite (in OpenGL coordinates)
+    * Getters
     **************************************************************************/
-   AnimatedSprite(Graphics* pGraphic, std::string texture,
-      int width, int height, float frameRate = 10);
+   const Texture* getTexture()    const { return mpTexture;   }
+   int            getFrameCount() const { return mFrameCount; }
+   float          getFrameRate()  const { return mFrameRate;  }
+
+   /***************************************************************************
+    * draw: draws one frame
+    *    INPUT: pGraphics    : where to draw
+    *           x, y         : center point
+    *           width, height: size (in OpenGL coordinates)
+    *           rot          : rotation
+    *           frame        : which frame
+    *           alpha        : opacity, 0 to 1
+    **************************************************************************/
+   void draw(Graphics* pGraphics, float x, float y, float width, 
+             float height, float rot, int frame, float alpha = 1) const;
+};
 
-   /***************************************************************************
-    * draw: draws the sprite to the screen with the given position and rotation
-    *    INPUT: x  : center point x position
-    *           y  : center point y position
-    *           rot: the sprite's rotation
-    *           dt : time elapsed since last draw (in milliseconds)
+/******************************************************************************
+ * SpriteInstance: the little that is particular to one entity's sprite. 
+ *    Kept inside the entity, so spawning one allocates nothing. The 
+ *    EffectTimeline animates width, height, visible, alpha and spin
+ *****************************************************************************/
+struct SpriteInstance
+{
+   const SpriteDef* pDef;
+   int              elapsed; // draws so far
+   float            width;
+   float            height;
+   float            alpha;
+   float            spin;    // degrees added to the entity's rotation
+   int              tweens;  // first of its tweens in the timeline, or -1
+   bool             visible;
+
+   /***************************************************************************
+    * draw: draws the current frame and moves the animation on
+    *    INPUT: pGraphics: where to draw
+    *           x, y     : center point
+    *           rot      : rotation
+    *           dt       : time elapsed since last draw
     **************************************************************************/
-   virtual void draw(float x, float y, float r, float dt);
+   void draw(Graphics* pGraphics, float x, float y, float rot, float dt);
 };
 
 /******************************************************************************
- * Sprite: draws tiling 2D textures on the screen using OpenGL
+ * Sprite: draws tiling 2D textures on the screen using OpenGL. The tiling 
+ *    relies on texture repeat, so the texture can't be in the atlas
  *****************************************************************************/
 class TilingSprite : public Sprite
 {
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * store.cpp: implements the EntityStore class
+ *****************************************************************************/
+#include "store.h"
+#include "kernel.h"
+#include "entity.h"
+#include <assert.h>
+using namespace std;
+
+/******************************************************************************
+ * add: claims a new slot at the end of the arrays
+ *    INPUT : pOwner  : the entity the slot belongs to (may be NULL)
+ *            v       : starting position and velocity
+ *    OUTPUT: <return>: the new slot
+ *****************************************************************************/
+int EntityStore::add(Moveable* pOwner, const Vector &v)
+{
+   mX.push_back(v.getX());
+   mY.push_back(v.getY());
+   mDX.push_back(v.getDX());
+   mDY.push_back(v.getDY());
+   mRotation.push_back(0);
+   mSpin.push_back(0);
+   mRadius.push_back(0);
+   mLifetime.push_back(LIFETIME_UNLIMITED);
+   mCategory.push_back(CAT_EFFECT);
+   mDead.push_back(false);
+   mOwners.push_back(pOwner);
+
+   return size() - 1;
+}
+
+/******************************************************************************
+ * remove: releases a slot by moving the last slot into its place
+ *    INPUT: slot: the slot to release
+ *****************************************************************************/
+void EntityStore::remove(int slot)
+{
+   assert(slot >= 0 && slot < size());
+
+   int last = size() - 1;
+
+   if (slot != last)
+   {
+      mX[slot]        = mX[last];
+      mY[slot]        = mY[last];
+      mDX[slot]       = mDX[last];
+      mDY[slot]       = mDY[last];
+      mRotation[slot] = mRotation[last];
+      mSpin[slot]     = mSpin[last];
+      mRadius[slot]   = mRadius[last];
+      mLifetime[slot] = mLifetime[last];
+      mCategory[slot] = mCategory[last];
+      mDead[slot]     = mDead[last];
+      mOwners[slot]   = mOwners[last];
+
+      // Let the moved entity know where it lives now
+      if (mOwners[slot] != NULL)
+         mOwners[slot]->mSlot = slot;
+   }
+
+   mX.pop_back();
+   mY.pop_back();
+   mDX.pop_back();
+   mDY.pop_back();
+   mRotation.pop_back();
+   mSpin.pop_back();
+   mRadius.pop_back();
+   mLifetime.pop_back();
+   mCategory.pop_back();
+   mDead.pop_back();
+   mOwners.pop_back();
+}
+
+/******************************************************************************
+ * reserve: preallocates room for the given number of entities
+ *****************************************************************************/
+void EntityStore::reserve(int count)
+{
+   mX.reserve(count);
+   mY.reserve(count);
+   mDX.reserve(count);
+   mDY.reserve(count);
+   mRotation.reserve(count);
+   mSpin.reserve(count);
+   mRadius.reserve(count);
+   mLifetime.reserve(count);
+   mCategory.reserve(count);
+   mDead.reserve(count);
+   mOwners.reserve(count);
+}
+
+/******************************************************************************
+ * integrate: advances every entity along its velocity, spins it, wraps it
+ *    back onto the screen and counts down its lifetime
+ *    INPUT: dt        : the amount of time that has passed, in seconds
+ *           xMin, xMax: horizontal bounds of the screen
+ *           yMin, yMax: vertical bounds of the screen
+ *****************************************************************************/
+void EntityStore::integrate(float dt, float xMin, float xMax, 
+   float yMin, float yMax)
+{
+   integrate(dt, xMin, xMax, yMin, yMax, 0, size());
+}
+
+/******************************************************************************
+ * integrate: the same, for the slots [begin, end) only
+ *****************************************************************************/
+void EntityStore::integrate(float dt, float xMin, float xMax, 
+   float yMin, float yMax, int begin, int end)
+{
+   int count = end - begin;
+
+   // Move and wrap (a wrapped entity reappears on the opposite edge)
+   advance(mX.data() + begin, mY.data() + begin, 
+           mDX.data() + begin, mDY.data() + begin, count, 
+           dt, xMin, xMax, yMin, yMax);
+
+   // Spin
+   for (int i = begin; i < end; i++)
+   {
+      mRotation[i] += mSpin[i] * dt;
+   }
+
+   // Count down the entities with a limited lifetime
+   for (int i = begin; i < end; i++)
+   {
+      if (mLifetime[i] > 0)
+      {
+         mLifetime[i] -= dt;
+         if (mLifetime[i] <= 0)
+            mDead[i] = true;
+      }
+   }
+}
+
+/******************************************************************************
+ * getVector: builds a Vector from the position and velocity of a slot
+ *****************************************************************************/
+Vector EntityStore::getVector(int slot) const
+{
+   return Vector(mX[slot], mY[slot], mDX[slot], mDY[slot]);
+}
+
+/******************************************************************************
+ * setVector: sets both the position and velocity of a slot
+ *****************************************************************************/
+void EntityStore::setVector(int slot, const Vector &v)
+{
+   mX[slot]  = v.getX();
+   mY[slot]  = v.getY();
+   mDX[slot] = v.getDX();
+   mDY[slot] = v.getDY();
+}
@@ -0,0 +1,136 @@
+/******************************************************************************
+ * store.h: defines the EntityStore class which keeps the state used by the 
+ *    update, wrap and collision passes in contiguous per-field arrays
+ *****************************************************************************/
+#ifndef STORE_H
+#define STORE_H
+
+#include "vector.h"
+#include <vector>
+
+/******************************************************************************
+ * Forward declarations
+ *****************************************************************************/
+class Moveable;
+
+/******************************************************************************
+ * Lifetime value for entities that only die when killed
+ *****************************************************************************/
+#define LIFETIME_UNLIMITED -1.0f
+
+/******************************************************************************
+ * Category: what kind of entity a slot holds, which decides what it can 
+ *    collide with (see collision.h)
+ *****************************************************************************/
+enum Category
+{
+   CAT_EFFECT,  // explosions and anything else that never collides
+   CAT_BULLET,
+   CAT_MISSILE,
+   CAT_ROCK,
+   CAT_SHIP,
+   CAT_SAUCER,
+   CAT_COUNT
+};
+
+/******************************************************************************
+ * EntityStore: structure-of-arrays storage for the game entities. Each 
+ *    entity owns one slot; slot i of every array belongs to the same entity.
+ *    Removing an entity moves the last slot into the hole (swap-and-pop), so 
+ *    the arrays never have gaps and slots are NOT stable across removals.
+ *    The owning Moveable is told its new slot whenever it moves.
+ *****************************************************************************/
+class EntityStore
+{
+private:
+
+   std::vector<float>         mX;
+   std::vector<float>         mY;
+   std::vector<float>         mDX;
+   std::vector<float>         mDY;
+   std::vector<float>         mRotation;
+   std::vector<float>         mSpin;     // degrees per second
+   std::vector<float>         mRadius;   // collision radius
+   std::vector<float>         mLifetime; // seconds left, or LIFETIME_UNLIMITED
+   std::vector<unsigned char> mCategory;
+   std::vector<char>          mDead;
+   std::vector<Moveable*>     mOwners;
+
+public:
+
+   /***************************************************************************
+    * add: claims a new slot at the end of the arrays
+    *    INPUT : pOwner  : the entity the slot belongs to (may be NULL)
+    *            v       : starting position and velocity
+    *    OUTPUT: <return>: the new slot
+    **************************************************************************/
+   int add(Moveable* pOwner, const Vector &v);
+
+   /***************************************************************************
+    * remove: releases a slot by moving the last slot into its place
+    *    INPUT: slot: the slot to release
+    **************************************************************************/
+   void remove(int slot);
+
+   /***************************************************************************
+    * reserve: preallocates room for the given number of entities
+    **************************************************************************/
+   void reserve(int count);
+
+   /***************************************************************************
+    * integrate: advances every entity along its velocity, spins it, wraps it
+    *    back onto the screen and counts down its lifetime
+    *    INPUT: dt        : the amount of time that has passed, in seconds
+    *           xMin, xMax: horizontal bounds of the screen
+    *           yMin, yMax: vertical bounds of the screen
+    **************************************************************************/
+   void integrate(float dt, float xMin, float xMax, float yMin, float yMax);
+
+   /***************************************************************************
+    * integrate: the same, for the slots [begin, end) only. Slots are 
+    *    independent, so separate ranges can be integrated at the same time
+    **************************************************************************/
+   void integrate(float dt, float xMin, float xMax, float yMin, float yMax,
+                  int begin, int end);
+
+   /***************************************************************************
+    * Getters
+    **************************************************************************/
+   int       size()              const { return (int)mOwners.size(); }
+   Moveable* getOwner(int slot)  const { return mOwners[slot];       }
+   Vector    getVector(int slot) const;
+
+   /***************************************************************************
+    * Field access (by slot)
+    **************************************************************************/
+   float         &x       (int slot) { return mX[slot];        }
+   float         &y       (int slot) { return mY[slot];        }
+   float         &dx      (int slot) { return mDX[slot];       }
+   float         &dy      (int slot) { return mDY[slot];       }
+   float         &rotation(int slot) { return mRotation[slot]; }
+   float         &spin    (int slot) { return mSpin[slot];     }
+   float         &radius  (int slot) { return mRadius[slot];   }
+   float         &lifetime(int slot) { return mLifetime[slot]; }
+   char          &dead    (int slot) { return mDead[slot];     }
+
+   float    x       (int slot) const { return mX[slot];                  }
+   float    y       (int slot) const { return mY[slot];                  }
+   float    radius  (int slot) const { return mRadius[slot];             }
+   Category category(int slot) const { return (Category)mCategory[slot]; }
+   char     dead    (int slot) const { return mDead[slot];               }
+
+   /***************************************************************************
+    * setVector: sets both the position and velocity of a slot
+    **************************************************************************/
+   void setVector(int slot, const Vector &v);
+
+   /***************************************************************************
+    * setCategory: sets what kind of entity a slot holds
+    **************************************************************************/
+   void setCategory(int slot, Category category)
+   {
+      mCategory[slot] = (unsigned char)category;
+   }
+};
+
+#endif
@@ -0,0 +1,165 @@
+/******************************************************************************
+ * storeTest.cpp: benchmarks one update tick (move, wrap and lifetime) of the
+ *    EntityStore arrays against the old layout, a std::list of separately
+ *    allocated polymorphic entities, at 1k, 10k and 100k entities
+ *****************************************************************************/
+#include "store.h"
+#include "vector.h"
+#include <list>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <time.h>
+using namespace std;
+
+/******************************************************************************
+ * Bounds: stands in for the Environment the old entities called back into
+ *****************************************************************************/
+class Bounds
+{
+public:
+   virtual float getXMax() const { return 400; }
+   virtual float getXMin() const { return   0; }
+   virtual float getYMax() const { return 400; }
+   virtual float getYMin() const { return   0; }
+};
+
+/******************************************************************************
+ * OldMoveable: the per-entity layout that used to live in the list
+ *****************************************************************************/
+class OldMoveable
+{
+public:
+   OldMoveable(Bounds* pBounds, Vector v, float timeLeft)
+      : vector(v), rotation(0), pBounds(pBounds), size(10), 
+        timeLeft(timeLeft), fDead(false) { }
+   virtual ~OldMoveable() { }
+
+   virtual void operator+=(float dt)
+   {
+      vector.advance(dt);
+      wrap();
+      timeLeft -= dt;
+      if (timeLeft <= 0)
+         fDead = true;
+   }
+
+   void wrap()
+   {
+      if (vector.getX() > pBounds->getXMax())
+         vector.setX(pBounds->getXMin());
+      if (vector.getX() < pBounds->getXMin())
+         vector.setX(pBounds->getXMax());
+      if (vector.getY() > pBounds->getYMax())
+         vector.setY(pBounds->getYMin());
+      if (vector.getY() < pBounds->getYMin())
+         vector.setY(pBounds->getYMax());
+   }
+
+private:
+   Vector              vector;
+   float               rotation;
+   Bounds*             pBounds;
+   int                 size;
+   float               timeLeft;
+   std::vector<void*>  sprites;
+   bool                fDead;
+};
+
+/******************************************************************************
+ * now: current time in seconds
+ *****************************************************************************/
+double now()
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/******************************************************************************
+ * randomVector: somewhere on the screen, drifting in some direction
+ *****************************************************************************/
+Vector randomVector()
+{
+   return Vector(rand() % 400, rand() % 400, rand() % 100 - 50, 
+      rand() % 100 - 50);
+}
+
+/******************************************************************************
+ * timeList: average seconds per tick for the old list of entities
+ *****************************************************************************/
+double timeList(int count, int ticks)
+{
+   Bounds bounds;
+   vector<OldMoveable*> entities;
+
+   // Link the entities in a different order than they were allocated in,
+   // the way entities spawned over a whole game end up
+   for (int i = 0; i < count; i++)
+      entities.push_back(new OldMoveable(&bounds, randomVector(), 1e9));
+   for (int i = count - 1; i > 0; i--)
+      swap(entities[i], entities[rand() % (i + 1)]);
+
+   list<OldMoveable*> entityList(entities.begin(), entities.end());
+
+   double start = now();
+   for (int t = 0; t < ticks; t++)
+   {
+      for (list<OldMoveable*>::iterator it = entityList.begin();
+         it != entityList.end(); it++)
+      {
+         *(*it) += 1.0f / 120;
+      }
+   }
+   double elapsed = now() - start;
+
+   for (int i = 0; i < count; i++)
+      delete entities[i];
+
+   return elapsed / ticks;
+}
+
+/******************************************************************************
+ * timeStore: average seconds per tick for the entity store
+ *****************************************************************************/
+double timeStore(int count, int ticks)
+{
+   EntityStore store;
+   store.reserve(count);
+
+   for (int i = 0; i < count; i++)
+      store.lifetime(store.add(NULL, randomVector())) = 1e9;
+
+   double start = now();
+   for (int t = 0; t < ticks; t++)
+   {
+      store.integrate(1.0f / 120, 0, 400, 0, 400);
+   }
+   return (now() - start) / ticks;
+}
+
+/******************************************************************************
+ * main: runs each size and prints the time per tick
+ *****************************************************************************/
+int main()
+{
+   int sizes[] = { 1000, 10000, 100000 };
+
+   srand(1);
+
+   cout << setw(10) << "entities" << setw(16) << "list (us/tick)"
+        << setw(16) << "store (us/tick)" << setw(10) << "speedup\n";
+
+   for (int i = 0; i < 3; i++)
+   {
+      int ticks = 10000000 / sizes[i];
+      double list  = timeList (sizes[i], ticks) * 1e6;
+      double store = timeStore(sizes[i], ticks) * 1e6;
+
+      cout << setw(10) << sizes[i]
+           << setw(16) << fixed << setprecision(2) << list
+           << setw(16) << store 
+           << setw(9)  << list / store << "x\n";
+   }
+
+   return 0;
+}
@@ -0,0 +1,271 @@
+/******************************************************************************
+ * stream.cpp: implements the StreamingSound
+ *****************************************************************************/
+#include "stream.h"
+#include "mixer.h"
+#include <string.h>
+#include <algorithm>
+using namespace std;
+
+/******************************************************************************
+ * readLE: reads a little-endian number from a file
+ *    INPUT : pFile   : the file
+ *            bytes   : its size (2 or 4)
+ *            filename: for the error
+ *    OUTPUT: <return>: the number
+ *****************************************************************************/
+static Uint32 readLE(SDL_RWops* pFile, int bytes, const string &filename)
+{
+   Uint8 b[4] = { 0, 0, 0, 0 };
+
+   if (SDL_RWread(pFile, b, 1, bytes) != (size_t)bytes)
+      throw string("Unexpected end of sound file: ") + filename;
+
+   return b[0] | (b[1] << 8) | (b[2] << 16) | ((Uint32)b[3] << 24);
+}
+
+/******************************************************************************
+ * readId: reads a four character chunk id
+ *****************************************************************************/
+static bool readId(SDL_RWops* pFile, const char* id)
+{
+   char found[4];
+   return SDL_RWread(pFile, found, 1, 4) == 4 && memcmp(found, id, 4) == 0;
+}
+
+/******************************************************************************
+ * StreamingSound: opens a WAV file and starts reading it
+ *    INPUT: filename: name of the file to stream
+ *           spec    : format settings to convert to
+ *           loop    : start the file over whenever it finishes
+ *****************************************************************************/
+StreamingSound::StreamingSound(string filename, SDL_AudioSpec *spec,
+                               bool loop)
+   : Sound(filename), mpFile(NULL), mDataRead(0), mLoopFile(loop),
+     mEnded(false), mDone(false), mUnderruns(0)
+{
+   try
+   {
+      open(spec);
+   }
+   catch (string ex)
+   {
+      if (mpFile != NULL)
+         SDL_RWclose(mpFile);
+      throw ex;
+   }
+
+   // The voice's position stays at 0 while there is more to come and is
+   // moved to mLength when the stream ends (or the voice is stopped)
+   mLength = 1;
+   mLimit  = 1;
+
+   mScratch.resize(STREAM_CHUNK_FRAMES * mChannels);
+
+   // Buffer the start before returning, so the music starts right away.
+   // A quarter of the ring plus one chunk (however much conversion grows
+   // it) always fits, so this never waits for the mixer
+   bool more = true;
+   while (more && mBuffer.getCount() < STREAM_BUFFER_SAMPLES / 4)
+      more = readChunk();
+
+   if (more)
+      mReader = thread(&StreamingSound::read, this);
+   else
+      mEnded = true;
+}
+
+/******************************************************************************
+ * ~StreamingSound: stops the reader and closes the file
+ *****************************************************************************/
+StreamingSound::~StreamingSound()
+{
+   mDone = true;
+   if (mReader.joinable())
+      mReader.join();
+
+   SDL_RWclose(mpFile);
+}
+
+/******************************************************************************
+ * open: reads the WAV header and finds the samples. Only uncompressed 8 and
+ *    16 bit files can be streamed
+ *    INPUT: spec: the format to convert to
+ *****************************************************************************/
+void StreamingSound::open(SDL_AudioSpec *spec)
+{
+   mpFile = SDL_RWFromFile(mFilename.c_str(), "rb");
+   if (mpFile == NULL)
+      throw string("Unable to load sound file: ") + mFilename;
+
+   if (!readId(mpFile, "RIFF"))
+      throw string("Not a WAV file: ") + mFilename;
+   readLE(mpFile, 4, mFilename);
+   if (!readId(mpFile, "WAVE"))
+      throw string("Not a WAV file: ") + mFilename;
+
+   // Walk the chunks to the format, then the samples
+   int    format   = 0;
+   int    channels = 0;
+   int    rate     = 0;
+   int    bits     = 0;
+
+   while (true)
+   {
+      char   id[4];
+      if (SDL_RWread(mpFile, id, 1, 4) != 4)
+         throw string("No samples in sound file: ") + mFilename;
+      Uint32 size = readLE(mpFile, 4, mFilename);
+
+      if (memcmp(id, "fmt ", 4) == 0)
+      {
+         format      = readLE(mpFile, 2, mFilename);
+         channels    = readLE(mpFile, 2, mFilename);
+         rate        = readLE(mpFile, 4, mFilename);
+         readLE(mpFile, 4, mFilename); // bytes per second
+         mFrameBytes = readLE(mpFile, 2, mFilename);
+         bits        = readLE(mpFile, 2, mFilename);
+         SDL_RWseek(mpFile, size - 16 + (size & 1), RW_SEEK_CUR);
+      }
+      else if (memcmp(id, "data", 4) == 0)
+      {
+         mDataStart  = SDL_RWtell(mpFile);
+         mDataLength = size;
+         break;
+      }
+      else
+         SDL_RWseek(mpFile, size + (size & 1), RW_SEEK_CUR);
+   }
+
+   if (format != 1 || (bits != 8 && bits != 16) || channels < 1 ||
+       mFrameBytes != channels * bits / 8)
+      throw string("Unable to stream sound ") + mFilename;
+
+   // Build a conversion structure for converting each chunk
+   if (SDL_BuildAudioCVT(&mConvert,
+      bits == 8 ? AUDIO_U8 : AUDIO_S16LSB, channels, rate,
+      spec->format, spec->channels, spec->freq) < 0)
+   {
+      throw string("Unable to convert sound ") + mFilename;
+   }
+
+   mChannels = spec->channels;
+   mChunk.resize(STREAM_CHUNK_FRAMES * mFrameBytes * mConvert.len_mult);
+}
+
+/******************************************************************************
+ * readChunk: reads, converts and buffers the next chunk of the file,
+ *    waiting for room in the ring
+ *    OUTPUT: <return>: false once the file is finished (or mDone is set)
+ *****************************************************************************/
+bool StreamingSound::readChunk()
+{
+   if (mDataRead >= mDataLength)
+   {
+      if (!mLoopFile || mDataLength == 0)
+         return false;
+
+      SDL_RWseek(mpFile, mDataStart, RW_SEEK_SET);
+      mDataRead = 0;
+   }
+
+   Uint32 bytes = min((Uint32)(STREAM_CHUNK_FRAMES * mFrameBytes),
+                      mDataLength - mDataRead);
+   int got = SDL_RWread(mpFile, mChunk.data(), 1, bytes);
+   got -= got % mFrameBytes;
+
+   if (got <= 0)
+   {
+      // The file is shorter than its header says
+      if (mDataRead == 0)
+         return false;
+      mDataLength = mDataRead;
+      return true;
+   }
+   mDataRead += got;
+
+   // Convert in place (the chunk has room for the growth)
+   int converted = got;
+   if (mConvert.needed)
+   {
+      mConvert.buf = mChunk.data();
+      mConvert.len = got;
+      if (SDL_ConvertAudio(&mConvert) < 0)
+         return false;
+      converted = mConvert.len_cvt;
+   }
+
+   // Whole frames only, so the mixer never gets the channels swapped
+   const Sint16* pSamples = (const Sint16*)mChunk.data();
+   int           count    = converted / 2;
+   count -= count % mChannels;
+
+   while (count > 0)
+   {
+      if (mDone)
+         return false;
+
+      int room = mBuffer.getCapacity() - mBuffer.getCount();
+      room -= room % mChannels;
+
+      int written = mBuffer.write(pSamples, min(count, room));
+      pSamples += written;
+      count    -= written;
+
+      if (count > 0)
+         SDL_Delay(STREAM_POLL_MS);
+   }
+
+   return true;
+}
+
+/******************************************************************************
+ * read: the reader thread: buffers chunks until the file is finished
+ *****************************************************************************/
+void StreamingSound::read()
+{
+   while (!mDone && readChunk())
+      ;
+
+   mEnded.store(true, memory_order_release);
+}
+
+/******************************************************************************
+ * mix: mixes what the reader has buffered into the audio stream
+ *    INPUT : audio:  accumulator to mix into (see mixer.h)
+ *            length: maximum length of the sound data to mix (bytes)
+ *            volume: volume of the sound
+ *****************************************************************************/
+void StreamingSound::mix(int *audio, int length, int volume,
+                         int &position) const
+{
+   if (position >= (int)mLength)
+      return; // Stopped
+
+   int wanted = length / 2;
+   wanted -= wanted % mChannels;
+
+   while (wanted > 0)
+   {
+      int count = min(min(wanted, (int)mScratch.size()), mBuffer.getCount());
+      count -= count % mChannels;
+      if (count == 0)
+         break;
+
+      mBuffer.read(mScratch.data(), count);
+      ::mix(audio, mScratch.data(), count, volume);
+
+      audio  += count;
+      wanted -= count;
+   }
+
+   if (wanted > 0)
+   {
+      // Either everything has been played or the reader is behind
+      if (mEnded.load(memory_order_acquire) &&
+          mBuffer.getCount() < mChannels)
+         position = mLength;
+      else
+         mUnderruns++;
+   }
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * stream.h: defines the StreamingSound, a Sound that is read from its file
+ *    a little at a time while it plays rather than loaded whole
+ *****************************************************************************/
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "sound.h"
+#include "ring.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define STREAM_BUFFER_SAMPLES 32768 // converted samples buffered (power of
+                                    // 2): ~370 ms of 44.1 kHz stereo
+#define STREAM_CHUNK_FRAMES   2048  // frames read from the file at a time
+#define STREAM_POLL_MS        10    // how long the reader sleeps when the
+                                    // buffer is full
+
+/******************************************************************************
+ * StreamingSound: a WAV file played as it is read. A reader thread reads
+ *    the file a chunk at a time, converts each chunk to the device format
+ *    and writes it into a ring that the mixer reads from, so only the ring
+ *    and one chunk are ever in memory. The first chunk is read before the
+ *    constructor returns, so playing can start at once.
+ *
+ *    The file is read once, or over and over if looped, and every voice
+ *    takes from the same ring; so a stream is limited to one voice, and
+ *    playing it again carries on from where it has got to. If the reader
+ *    falls behind the mixer, the gap is silent and counted as an underrun
+ *****************************************************************************/
+class StreamingSound : public Sound
+{
+private:
+
+   // Reader thread only (and the constructor, before it starts)
+   SDL_RWops*        mpFile;
+   Uint32            mDataStart;  // where the samples begin in the file
+   Uint32            mDataLength; // bytes of samples
+   Uint32            mDataRead;   // bytes read so far this time through
+   int               mFrameBytes; // bytes per frame in the file
+   SDL_AudioCVT      mConvert;
+   std::vector<Uint8> mChunk;
+   bool              mLoopFile;
+
+   // Shared
+   int               mChannels;   // of the converted samples
+   mutable Ring<Sint16, STREAM_BUFFER_SAMPLES> mBuffer;
+   std::atomic<bool> mEnded;      // the reader has written everything
+   std::atomic<bool> mDone;       // the reader should stop
+   mutable std::atomic<int> mUnderruns;
+   std::thread       mReader;
+
+   // Mixer only
+   mutable std::vector<Sint16> mScratch;
+
+   /***************************************************************************
+    * open: reads the WAV header and finds the samples
+    *    INPUT: spec: the format to convert to
+    **************************************************************************/
+   void open(SDL_AudioSpec *spec);
+
+   /***************************************************************************
+    * readChunk: reads, converts and buffers the next chunk of the file,
+    *    waiting for room in the ring
+    *    OUTPUT: <return>: false once the file is finished (or mDone is set)
+    **************************************************************************/
+   bool readChunk();
+
+   /***************************************************************************
+    * read: the reader thread: buffers chunks until the file is finished
+    **************************************************************************/
+   void read();
+
+public:
+
+   /***************************************************************************
+    * StreamingSound: opens a WAV file and starts reading it
+    *    INPUT: filename: name of the file to stream
+    *           spec    : format settings to convert to
+    *           loop    : start the file over whenever it finishes
+    **************************************************************************/
+   StreamingSound(string filename, SDL_AudioSpec *spec, bool loop);
+
+   /***************************************************************************
+    * ~StreamingSound: stops the reader and closes the file
+    **************************************************************************/
+   virtual ~StreamingSound();
+
+   /***************************************************************************
+    * mix, loop: mix what the reader has buffered into the audio stream.
+    *    Whether the file loops was decided when it was opened, so the two
+    *    are the same
+    *    INPUT : audio:  accumulator to mix into (see mixer.h)
+    *            length: maximum length of the sound data to mix (bytes)
+    *            volume: volume of the sound
+    **************************************************************************/
+   virtual void mix(int *audio, int length, int volume, int &position) const;
+   virtual void loop(int *audio, int length, int volume, int &position) const
+   {
+      mix(audio, length, volume, position);
+   }
+
+   /***************************************************************************
+    * getUnderruns: the number of mixes the reader couldn't keep up with
+    **************************************************************************/
+   int getUnderruns() const { return mUnderruns; }
+};
+
+#endif
@@ -9,16 +9,21 @@ using namespace std;
  *****************************************************************************/
 Texture::~Texture()
 {
-   glDeleteTextures(1, &mId);
+   if (mOwner && isUploaded())
+      glDeleteTextures(1, &mId);
 }
 
 /******************************************************************************
  * Texture: (developed with help from the SDL documentation
  *    INPUT: filename: name of the texture file (bitmap)
+ *           upload  : whether to create the OpenGL texture. Without it 
+ *                     only the dimensions are read (headless mode)
  *    NOTES: developed with help (not copied) from the SDL documentation and
  *       related tutorial sites
  *****************************************************************************/
-Texture::Texture(string filename) : mFilename(filename)
+Texture::Texture(string filename, bool upload) 
+   : mId(0), mFilename(filename), mOwner(true), mU0(0), mV0(0), mU1(1), 
+     mV1(1)
 {
    // Attemp to load the bitmap file as an SDL surface
    SDL_Surface *surface = SDL_LoadBMP(filename.c_str());
@@ -44,14 +49,20 @@ Texture::Texture(string filename) : mFilename(filename)
       throw string("Invalid image color format: " + filename);
    }
 
-   // Generate a texture handle and bind it
-   glGenTextures(1, &mId);
-   glBindTexture(GL_TEXTURE_2D, mId);
-
    // Set the texture's stretching properties and image data
    mWidth  = surface->w;
    mHeight = surface->h;
 
+   if (!upload)
+   {
+      SDL_FreeSurface(surface);
+      return;
+   }
+
+   // Generate a texture handle and bind it
+   glGenTextures(1, &mId);
+   glBindTexture(GL_TEXTURE_2D, mId);
+
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
@@ -61,3 +72,44 @@ Texture::Texture(string filename) : mFilename(filename)
    // Free resources and create a new Texture instance
    SDL_FreeSurface(surface);
 }
+
+/******************************************************************************
+ * Texture: an atlas page
+ *    INPUT: width, height: size of the page
+ *           pixels       : RGBA, 4 bytes per pixel, top row first
+ *           upload       : whether to create the OpenGL texture
+ *****************************************************************************/
+Texture::Texture(int width, int height, const void* pixels, bool upload)
+   : mId(0), mHeight(height), mWidth(width), mFilename("atlas"), 
+     mOwner(true), mU0(0), mV0(0), mU1(1), mV1(1)
+{
+   if (!upload)
+      return;
+
+   glGenTextures(1, &mId);
+   glBindTexture(GL_TEXTURE_2D, mId);
+
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+/******************************************************************************
+ * Texture: an image within an atlas page
+ *    INPUT: page         : the page
+ *           x, y         : its upper left-hand corner within the page
+ *           width, height: its size
+ *           filename     : the file it was read from
+ *****************************************************************************/
+Texture::Texture(const Texture &page, int x, int y, int width, int height,
+                 const string &filename)
+   : mId(page.mId), mHeight(height), mWidth(width), mFilename(filename),
+     mOwner(false)
+{
+   mU0 = (float) x           / page.mWidth;
+   mU1 = (float)(x + width)  / page.mWidth;
+   mV0 = (float) y           / page.mHeight;
+   mV1 = (float)(y + height) / page.mHeight;
+}
@@ -10,7 +10,9 @@
 #include <assert.h>
 
 /******************************************************************************
- * Texture: stores OpenGL textures and basic state info.
+ * Texture: stores OpenGL textures and basic state info. A texture can also 
+ *    be an image packed into an atlas page (see atlas.h): it then shares the
+ *    page's OpenGL texture and getU/getV map its coordinates into the page
  *****************************************************************************/
 class Texture
 {
@@ -20,16 +22,39 @@ private:
    int         mHeight;
    int         mWidth;
    std::string mFilename;
+   bool        mOwner;         // mId is deleted with this texture
+   float       mU0, mV0;       // the image's corners within mId
+   float       mU1, mV1;
 
 public:
 
    /***************************************************************************
     * Texture:
     *    INPUT: filename: name of the texture file (bitmap)
+    *           upload  : whether to create the OpenGL texture. Without it 
+    *                     only the dimensions are read (headless mode)
     *    NOTES: developed with help (not copied) from the SDL documentation and
     *    related tutorial sites
     **************************************************************************/
-   Texture(std::string filename);
+   Texture(std::string filename, bool upload = true);
+
+   /***************************************************************************
+    * Texture: an atlas page
+    *    INPUT: width, height: size of the page
+    *           pixels       : RGBA, 4 bytes per pixel, top row first
+    *           upload       : whether to create the OpenGL texture
+    **************************************************************************/
+   Texture(int width, int height, const void* pixels, bool upload = true);
+
+   /***************************************************************************
+    * Texture: an image within an atlas page
+    *    INPUT: page         : the page
+    *           x, y         : its upper left-hand corner within the page
+    *           width, height: its size
+    *           filename     : the file it was read from
+    **************************************************************************/
+   Texture(const Texture &page, int x, int y, int width, int height, 
+           const std::string &filename);
 
    /***************************************************************************
     * ~Texture()
@@ -42,6 +67,14 @@ public:
    int getWidth()  const { return mWidth;  }
    int getHeight() const { return mHeight; }
    GLuint getId()  const { return  mId;    }
+   bool isUploaded() const { return mId != 0; }
+
+   /***************************************************************************
+    * getU, getV: texture coordinates for a position within the image
+    *    INPUT: t: 0 at the image's left (top) edge, 1 at its right (bottom)
+    **************************************************************************/
+   float getU(float t) const { return mU0 + t * (mU1 - mU0); }
+   float getV(float t) const { return mV0 + t * (mV1 - mV0); }
 };
 
 #endif
\ No newline at end of file
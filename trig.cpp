@@ -0,0 +1,164 @@
+/******************************************************************************
+ * trig.cpp: implements the batched sine and cosine kernels
+ *****************************************************************************/
+#include "trig.h"
+
+#ifdef KERNEL_X86
+   #include <immintrin.h>
+#endif
+
+/******************************************************************************
+ * sinCosScalar: one angle at a time. Also finishes the angles left over by
+ *    the wider kernels
+ *****************************************************************************/
+void sinCosScalar(const float* degrees, float* s, float* c, int count)
+{
+   for (int i = 0; i < count; i++)
+      sinCos(degrees[i], s[i], c[i]);
+}
+
+#ifdef KERNEL_X86
+
+/******************************************************************************
+ * sinCosSSE: four angles at a time. Each step is the scalar sinCos's, in 
+ *    the same order, with the choices made by and/andnot/or
+ *****************************************************************************/
+__attribute__((target("sse")))
+void sinCosSSE(const float* degrees, float* s, float* c, int count)
+{
+   const __m128 round   = _mm_set1_ps(TRIG_ROUND);
+   const __m128 sign    = _mm_set1_ps(-0.0f);
+   const __m128 one     = _mm_set1_ps(1.0f);
+   const __m128 half    = _mm_set1_ps(0.5f);
+   const __m128 oneHalf = _mm_set1_ps(1.5f);
+
+   int i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128 d = _mm_loadu_ps(degrees + i);
+
+      __m128 k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(d, 
+                    _mm_set1_ps(1.0f / 90.0f)), round), round);
+      __m128 h = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(k, 
+                    _mm_set1_ps(0.25f)), round), round);
+      __m128 q = _mm_sub_ps(k, _mm_mul_ps(h, _mm_set1_ps(4.0f)));
+
+      __m128 r = _mm_mul_ps(_mm_sub_ps(d, _mm_mul_ps(k, _mm_set1_ps(90.0f))),
+                            _mm_set1_ps(TRIG_RADIANS));
+      __m128 z = _mm_mul_ps(r, r);
+
+      __m128 sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(
+                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(TRIG_S3), z), 
+                     _mm_set1_ps(TRIG_S2)), z), _mm_set1_ps(TRIG_S1)), z), 
+                     r), r);
+      __m128 cr = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_add_ps(
+                     _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(TRIG_C3), 
+                     z), _mm_set1_ps(TRIG_C2)), z), _mm_set1_ps(TRIG_C1)), 
+                     z), z), _mm_mul_ps(half, z)), one);
+
+      __m128 swap = _mm_cmpeq_ps(_mm_andnot_ps(sign, q), one);
+      __m128 sv   = _mm_or_ps(_mm_and_ps(swap, cr), _mm_andnot_ps(swap, sr));
+      __m128 cv   = _mm_or_ps(_mm_and_ps(swap, sr), _mm_andnot_ps(swap, cr));
+
+      __m128 flipS = _mm_or_ps(_mm_cmplt_ps(q, _mm_sub_ps(_mm_setzero_ps(),
+                                                          half)),
+                               _mm_cmpgt_ps(q, oneHalf));
+      __m128 flipC = _mm_or_ps(_mm_cmpgt_ps(q, half),
+                               _mm_cmplt_ps(q, _mm_sub_ps(_mm_setzero_ps(),
+                                                          oneHalf)));
+
+      _mm_storeu_ps(s + i, _mm_xor_ps(sv, _mm_and_ps(flipS, sign)));
+      _mm_storeu_ps(c + i, _mm_xor_ps(cv, _mm_and_ps(flipC, sign)));
+   }
+
+   sinCosScalar(degrees + i, s + i, c + i, count - i);
+}
+
+/******************************************************************************
+ * sinCosAVX: eight angles at a time, the same steps as sinCosSSE
+ *****************************************************************************/
+__attribute__((target("avx")))
+void sinCosAVX(const float* degrees, float* s, float* c, int count)
+{
+   const __m256 round   = _mm256_set1_ps(TRIG_ROUND);
+   const __m256 sign    = _mm256_set1_ps(-0.0f);
+   const __m256 one     = _mm256_set1_ps(1.0f);
+   const __m256 half    = _mm256_set1_ps(0.5f);
+   const __m256 oneHalf = _mm256_set1_ps(1.5f);
+
+   int i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      __m256 d = _mm256_loadu_ps(degrees + i);
+
+      __m256 k = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(d, 
+                    _mm256_set1_ps(1.0f / 90.0f)), round), round);
+      __m256 h = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(k, 
+                    _mm256_set1_ps(0.25f)), round), round);
+      __m256 q = _mm256_sub_ps(k, _mm256_mul_ps(h, _mm256_set1_ps(4.0f)));
+
+      __m256 r = _mm256_mul_ps(_mm256_sub_ps(d, 
+                    _mm256_mul_ps(k, _mm256_set1_ps(90.0f))),
+                    _mm256_set1_ps(TRIG_RADIANS));
+      __m256 z = _mm256_mul_ps(r, r);
+
+      __m256 sr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(
+                     _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(
+                     _mm256_set1_ps(TRIG_S3), z), _mm256_set1_ps(TRIG_S2)), 
+                     z), _mm256_set1_ps(TRIG_S1)), z), r), r);
+      __m256 cr = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(
+                     _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(
+                     _mm256_set1_ps(TRIG_C3), z), _mm256_set1_ps(TRIG_C2)), 
+                     z), _mm256_set1_ps(TRIG_C1)), z), z), 
+                     _mm256_mul_ps(half, z)), one);
+
+      __m256 swap = _mm256_cmp_ps(_mm256_andnot_ps(sign, q), one, _CMP_EQ_OQ);
+      __m256 sv   = _mm256_or_ps(_mm256_and_ps(swap, cr), 
+                                 _mm256_andnot_ps(swap, sr));
+      __m256 cv   = _mm256_or_ps(_mm256_and_ps(swap, sr), 
+                                 _mm256_andnot_ps(swap, cr));
+
+      __m256 minusHalf    = _mm256_sub_ps(_mm256_setzero_ps(), half);
+      __m256 minusOneHalf = _mm256_sub_ps(_mm256_setzero_ps(), oneHalf);
+
+      __m256 flipS = _mm256_or_ps(_mm256_cmp_ps(q, minusHalf, _CMP_LT_OQ),
+                                  _mm256_cmp_ps(q, oneHalf, _CMP_GT_OQ));
+      __m256 flipC = _mm256_or_ps(_mm256_cmp_ps(q, half, _CMP_GT_OQ),
+                                  _mm256_cmp_ps(q, minusOneHalf, _CMP_LT_OQ));
+
+      _mm256_storeu_ps(s + i, _mm256_xor_ps(sv, _mm256_and_ps(flipS, sign)));
+      _mm256_storeu_ps(c + i, _mm256_xor_ps(cv, _mm256_and_ps(flipC, sign)));
+   }
+
+   sinCosScalar(degrees + i, s + i, c + i, count - i);
+}
+
+#endif // KERNEL_X86
+
+/******************************************************************************
+ * getSinCosKernel: the kernel for a level, or for the best level below it 
+ *    when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+SinCosKernel getSinCosKernel(KernelLevel level)
+{
+   if (level > getKernelLevel())
+      level = getKernelLevel();
+
+#ifdef KERNEL_X86
+   if (level == KERNEL_AVX)
+      return sinCosAVX;
+   if (level == KERNEL_SSE)
+      return sinCosSSE;
+#endif
+   return sinCosScalar;
+}
+
+/******************************************************************************
+ * sinCos: runs the best kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void sinCos(const float* degrees, float* s, float* c, int count)
+{
+   static SinCosKernel kernel = getSinCosKernel(getKernelLevel());
+
+   kernel(degrees, s, c, count);
+}
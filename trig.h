@@ -0,0 +1,116 @@
+/******************************************************************************
+ * trig.h: defines fast sine and cosine of angles in degrees (the unit every
+ *    rotation in the game is kept in), one at a time and batched with SSE
+ *    and AVX versions picked at runtime
+ *****************************************************************************/
+#ifndef TRIG_H
+#define TRIG_H
+
+#include "kernel.h"
+#include <math.h>
+#include <float.h>
+
+/******************************************************************************
+ * Accuracy: every version gives the same, bit for bit (except on builds
+ *    with excess precision, where the scalar one may differ in the last 
+ *    bit). For |degrees| up to TRIG_MAX_DEGREES the sine and cosine are 
+ *    within TRIG_MAX_ERROR of the exact values (libm's sinf/cosf are within
+ *    about 6e-8; the worst seen by trigTest is 8.1e-8)
+ *****************************************************************************/
+#define TRIG_MAX_DEGREES 1e7f
+#define TRIG_MAX_ERROR   1e-7f
+
+/******************************************************************************
+ * The angle is split into a multiple of 90 degrees, which only chooses and
+ *    negates, and a remainder of at most 45 degrees, where short 
+ *    polynomials (Cephes' sinf and cosf) are as good as float gets. The 
+ *    rounding adds and subtracts TRIG_ROUND so it needs nothing beyond SSE
+ *    (see trigRound for the scalar version)
+ *****************************************************************************/
+#define TRIG_ROUND   12582912.0f         // 1.5 * 2^23
+#define TRIG_RADIANS 0.0174532925199433f // pi / 180
+
+#define TRIG_S1 -1.6666654611e-1f
+#define TRIG_S2  8.3321608736e-3f
+#define TRIG_S3 -1.9515295891e-4f
+#define TRIG_C1  4.166664568298827e-2f
+#define TRIG_C2 -1.388731625493765e-3f
+#define TRIG_C3  2.443315711809948e-5f
+
+/******************************************************************************
+ * trigRound: rounds to the nearest integer, ties to even, as the vector 
+ *    kernels do. Adding and subtracting TRIG_ROUND only rounds when the sum
+ *    is held as a float: with excess precision (FLT_EVAL_METHOD 2, as on an
+ *    x87 build) it passes through unrounded, so such builds use nearbyintf
+ *****************************************************************************/
+inline float trigRound(float x)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+   return (x + TRIG_ROUND) - TRIG_ROUND;
+#else
+   return nearbyintf(x);
+#endif
+}
+
+/******************************************************************************
+ * sinCos: the sine and cosine of an angle
+ *    INPUT : degrees: the angle, counterclockwise from the x axis
+ *    OUTPUT: s, c   : its sine and cosine
+ *****************************************************************************/
+inline void sinCos(float degrees, float &s, float &c)
+{
+   // k: nearest multiple of 90 degrees, q: which one, mod 4, in [-2, 2]
+   float k = trigRound(degrees * (1.0f / 90.0f));
+   float h = trigRound(k * 0.25f);
+   float q = k - h * 4.0f;
+
+   float r = (degrees - k * 90.0f) * TRIG_RADIANS;
+   float z = r * r;
+
+   float sr = ((TRIG_S3 * z + TRIG_S2) * z + TRIG_S1) * z * r + r;
+   float cr = ((TRIG_C3 * z + TRIG_C2) * z + TRIG_C1) * z * z - 0.5f * z 
+            + 1.0f;
+
+   // Looked up rather than branched on: the quadrant of a random angle 
+   // is a branch the CPU can't predict. Multiplying by +-1 is exact
+   static const float SIGN_S[4] = { 1.0f,  1.0f, -1.0f, -1.0f };
+   static const float SIGN_C[4] = { 1.0f, -1.0f, -1.0f,  1.0f };
+
+   int   quadrant = (int)q & 3;
+   float value[2] = { sr, cr };
+
+   s = value[quadrant & 1]       * SIGN_S[quadrant];
+   c = value[(quadrant & 1) ^ 1] * SIGN_C[quadrant];
+}
+
+/******************************************************************************
+ * SinCosKernel: the sine and cosine of count angles
+ *    INPUT : degrees: the angles
+ *            count  : number of angles
+ *    OUTPUT: s, c   : their sines and cosines
+ *****************************************************************************/
+typedef void (*SinCosKernel)(const float* degrees, float* s, float* c, 
+                             int count);
+
+/******************************************************************************
+ * The kernel for each level (see kernel.h). All of them give bit-identical 
+ *    results
+ *****************************************************************************/
+void sinCosScalar(const float* degrees, float* s, float* c, int count);
+#ifdef KERNEL_X86
+void sinCosSSE   (const float* degrees, float* s, float* c, int count);
+void sinCosAVX   (const float* degrees, float* s, float* c, int count);
+#endif
+
+/******************************************************************************
+ * getSinCosKernel: the kernel for a level, or for the best level below it 
+ *    when the CPU (or the build) doesn't support it
+ *****************************************************************************/
+SinCosKernel getSinCosKernel(KernelLevel level);
+
+/******************************************************************************
+ * sinCos: runs the best kernel for this CPU (chosen on first use)
+ *****************************************************************************/
+void sinCos(const float* degrees, float* s, float* c, int count);
+
+#endif
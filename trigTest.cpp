@@ -0,0 +1,165 @@
+/******************************************************************************
+ * trigTest.cpp: measures how far the fast sine and cosine are from the 
+ *    exact values, checks that every kernel matches the scalar one and 
+ *    compares their speed with libm's
+ *****************************************************************************/
+#include "trig.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+using namespace std;
+
+void fill(vector<float> &degrees, int count, float range);
+double testError(const vector<float> &degrees);
+bool testMatches(KernelLevel level, const vector<float> &degrees);
+double testSpeed(SinCosKernel kernel, const vector<float> &degrees);
+void libmFloat(const float* degrees, float* s, float* c, int count);
+void libmDouble(const float* degrees, float* s, float* c, int count);
+
+int main()
+{
+   KernelLevel best = getKernelLevel();
+
+   srand(1);
+
+   // Accuracy, from the angles the game uses to the largest supported
+   float ranges[] = { 360, 1e4f, TRIG_MAX_DEGREES };
+   bool  pass     = true;
+
+   cout << "bound: " << TRIG_MAX_ERROR << endl;
+   cout << setw(12) << "degrees" << setw(14) << "max error" 
+        << setw(10) << "matches\n";
+
+   for (int i = 0; i < 3; i++)
+   {
+      vector<float> degrees;
+      fill(degrees, 1000000, ranges[i]);
+
+      double error = testError(degrees);
+      bool matches = true;
+      for (int level = KERNEL_SSE; level <= best; level++)
+         matches = matches && testMatches((KernelLevel)level, degrees);
+
+      pass = pass && error <= TRIG_MAX_ERROR && matches;
+
+      cout << setw(12) << ranges[i] 
+           << setw(14) << scientific << setprecision(2) << error
+           << setw(9)  << (matches ? "yes" : "NO") << endl;
+   }
+
+   // Speed
+   vector<float> degrees;
+   fill(degrees, 10000, 360);
+
+   cout << setw(12) << "kernel" << setw(14) << "ns/angle\n" << fixed;
+   cout << setw(12) << "libm double" << setw(13) << setprecision(2)
+        << testSpeed(libmDouble, degrees) << endl;
+   cout << setw(12) << "libm float" << setw(13) 
+        << testSpeed(libmFloat, degrees) << endl;
+   for (int level = KERNEL_SCALAR; level <= best; level++)
+   {
+      cout << setw(12) << getKernelName((KernelLevel)level) << setw(13)
+           << testSpeed(getSinCosKernel((KernelLevel)level), degrees) 
+           << endl;
+   }
+
+   return pass ? 0 : 1;
+}
+
+/******************************************************************************
+ * fill: angles in [-range, range], including the multiples of 45 degrees
+ *    where the quadrant changes
+ *****************************************************************************/
+void fill(vector<float> &degrees, int count, float range)
+{
+   degrees.resize(count);
+
+   for (int i = 0; i < count; i++)
+   {
+      if (i % 16 == 0)
+         degrees[i] = 45.0f * (float)(i / 16 % 64 - 32);
+      else
+         degrees[i] = range * ((float)rand() / RAND_MAX * 2 - 1);
+   }
+}
+
+/******************************************************************************
+ * testError: the largest difference between the scalar sinCos and the 
+ *    exact (double precision) sine and cosine
+ *****************************************************************************/
+double testError(const vector<float> &degrees)
+{
+   double worst = 0;
+
+   for (int i = 0; i < (int)degrees.size(); i++)
+   {
+      float s, c;
+      sinCos(degrees[i], s, c);
+
+      // Reduce in double first, so the reference itself is exact
+      double reduced = fmod((double)degrees[i], 360.0) * M_PI / 180.0;
+      worst = max(worst, fabs(s - sin(reduced)));
+      worst = max(worst, fabs(c - cos(reduced)));
+   }
+
+   return worst;
+}
+
+/******************************************************************************
+ * testMatches: runs a kernel and the scalar kernel over the same angles 
+ *    and compares the results bit for bit
+ *****************************************************************************/
+bool testMatches(KernelLevel level, const vector<float> &degrees)
+{
+   int count = degrees.size();
+   vector<float> s(count), c(count), s2(count), c2(count);
+
+   getSinCosKernel(level)(degrees.data(), s.data(), c.data(), count);
+   sinCosScalar(degrees.data(), s2.data(), c2.data(), count);
+
+   return s == s2 && c == c2;
+}
+
+/******************************************************************************
+ * testSpeed: nanoseconds a kernel takes per angle
+ *****************************************************************************/
+double testSpeed(SinCosKernel kernel, const vector<float> &degrees)
+{
+   int count = degrees.size();
+   int runs  = 2000;
+   vector<float> s(count), c(count);
+
+   clock_t start = clock();
+   for (int r = 0; r < runs; r++)
+      kernel(degrees.data(), s.data(), c.data(), count);
+   double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   return seconds * 1e9 / ((double)count * runs);
+}
+
+/******************************************************************************
+ * libmFloat, libmDouble: the same job done with sinf/cosf and with 
+ *    sin/cos (what calcDX and calcDY used)
+ *****************************************************************************/
+void libmFloat(const float* degrees, float* s, float* c, int count)
+{
+   for (int i = 0; i < count; i++)
+   {
+      float theta = degrees[i] * TRIG_RADIANS;
+      s[i] = sinf(theta);
+      c[i] = cosf(theta);
+   }
+}
+
+void libmDouble(const float* degrees, float* s, float* c, int count)
+{
+   for (int i = 0; i < count; i++)
+   {
+      double theta = degrees[i] * M_PI / 180;
+      s[i] = (float)sin(theta);
+      c[i] = (float)cos(theta);
+   }
+}
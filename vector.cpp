@@ -7,6 +7,7 @@
 **********************************************************/
 
 #include "vector.h"
+#include "trig.h"
 #include <iostream>
 #include <math.h>
 using std::cout;
@@ -68,18 +69,24 @@ float Vector::operator - (const Vector &rhs) const
 ****************************************************/
 float calcDX(float angle, float hypotenuse)
 {
-	float dx;
-	float theta = (float)(angle * PI / 180);
-	dx = hypotenuse * cos(theta);
-	return dx;
+	float s, c;
+	sinCos(angle, s, c);
+	return hypotenuse * c;
 }
 
 float calcDY(float angle, float hypotenuse)
 {
-	float dy;
-	float theta = (float)(angle * PI / 180);
-	dy = hypotenuse * sin(theta);
-	return dy;
+	float s, c;
+	sinCos(angle, s, c);
+	return hypotenuse * s;
+}
+
+void calcDXDY(float angle, float hypotenuse, float &dx, float &dy)
+{
+	float s, c;
+	sinCos(angle, s, c);
+	dx = hypotenuse * c;
+	dy = hypotenuse * s;
 }
 
 /****************************************************
@@ -7,10 +7,12 @@
 
 /***************************************************
 * Functions to calculate a new dx and dy by knowing
-* the rotation angle and a tangent length.
+* the rotation angle and a tangent length. calcDXDY
+* gets both for the price of one (see trig.h)
 ****************************************************/
 float calcDX(float angle, float hypotenuse);
 float calcDY(float angle, float hypotenuse);
+void  calcDXDY(float angle, float hypotenuse, float &dx, float &dy);
 
 /*******************
  * POINT